@@ -1,9 +1,16 @@
+#ifndef ASIC_HPP
+#define ASIC_HPP
+
 #include <iostream>
 #include <vector>
 #include <string>
 #include <map>
+#include <string_view>
 #include "external/json/json.hpp"
 #include "Cell.hpp"
+#include "CellStore.hpp"
+#include "CellLibrary.hpp"
+#include "StringTable.hpp"
 
 using namespace std;
 
@@ -12,7 +19,8 @@ typedef struct
     vector<int> inputs;
     vector<int> outputs;
     vector<Cell> cells;
-    map<int, string> net_dict;
+    map<int, string_view> net_dict; // names live in net_names
+    StringTable net_names;
     vector<string> paths;
 } ASIC;
 
@@ -20,5 +28,13 @@ void display_asic(const ASIC &asic);
 ASIC parse_json(const string &filename);
 void print_cells(const ASIC &asic);
 void assign_rc_to_cells(ASIC& asic);
+void assign_rc_to_cell(Cell &cell);
+pair<double, double> get_rc(CellType type); // resistance, capacitance
+CellType parse_cell_type(string_view type_str);
+int get_delay(CellType type);
+bool is_sequential(CellType type);
+bool is_clock_pin(string_view pin);
+
+CellStore create_cell_store(const vector<Cell>& cells);
 
-map<int, Cell> create_cell_map(const vector<Cell>& cells);
+#endif // ASIC_HPP
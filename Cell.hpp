@@ -1,3 +1,6 @@
+#ifndef CELL_HPP
+#define CELL_HPP
+
 #include <vector>
 #include <string>
 #include "CellType.hpp"
@@ -13,4 +16,7 @@ typedef struct
     CellType type;
     vector<int> inputs;
     vector<int> outputs;
-} Cell;
\ No newline at end of file
+    vector<int> data_inputs; // registers only: the inputs on data pins, which end timing paths
+} Cell;
+
+#endif // CELL_HPP
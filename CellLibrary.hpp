@@ -0,0 +1,283 @@
+#ifndef CELL_LIBRARY_HPP
+#define CELL_LIBRARY_HPP
+
+#include <cstddef>
+#include <string_view>
+#include "CellType.hpp"
+
+// Characterization of one cell type. A delay of -1 marks a register, whose timing comes
+// from the clock (CLK2Q_*, SETUP_TIME, HOLD_TIME) instead.
+struct CellSpec
+{
+    CellType type;
+    std::string_view name; // Yosys / liberty cell name, empty for UNKNOWN
+    int delay;
+    double resistance;
+    double capacitance;
+    bool sequential;
+};
+
+// The cell library, one entry per CellType in enum order
+inline constexpr CellSpec CELL_LIBRARY[] = {
+    {CellType::UNKNOWN, "", 0, 100, 0.3e-12, false},
+    {CellType::NOT, "$_NOT_", 5, 125, 0.35e-12, false},
+    {CellType::AND, "$_AND_", 9, 150, 0.4e-12, false},
+    {CellType::OR, "$_OR_", 9, 175, 0.45e-12, false},
+    {CellType::XOR, "$_XOR_", 12, 200, 0.5e-12, false},
+    {CellType::NAND, "$_NAND_", 13, 100, 0.3e-12, false},
+    {CellType::NOR, "$_NOR_", 12, 125, 0.35e-12, false},
+    {CellType::XNOR, "$_XNOR_", 12, 150, 0.4e-12, false},
+    {CellType::DFF_P, "$_DFF_P_", -1, 175, 0.45e-12, true},
+    {CellType::DFF_PN0, "$_DFF_PN0_", -1, 200, 0.5e-12, true},
+    {CellType::MUX, "$_MUX_", 14, 100, 0.3e-12, false},
+    {CellType::AND2_X2, "AND2_X2", 8, 125, 0.35e-12, false},
+    {CellType::AND2_X4, "AND2_X4", 7, 150, 0.4e-12, false},
+    {CellType::AND3_X2, "AND3_X2", 10, 175, 0.45e-12, false},
+    {CellType::AND3_X4, "AND3_X4", 9, 200, 0.5e-12, false},
+    {CellType::AND4_X2, "AND4_X2", 12, 100, 0.3e-12, false},
+    {CellType::AND4_X4, "AND4_X4", 11, 125, 0.35e-12, false},
+    {CellType::AOI211_X2, "AOI211_X2", 13, 150, 0.4e-12, false},
+    {CellType::AOI21_X2, "AOI21_X2", 12, 175, 0.45e-12, false},
+    {CellType::AOI21_X4, "AOI21_X4", 11, 200, 0.5e-12, false},
+    {CellType::AOI221_X2, "AOI221_X2", 14, 100, 0.3e-12, false},
+    {CellType::AOI222_X1, "AOI222_X1", 14, 125, 0.35e-12, false},
+    {CellType::AOI222_X2, "AOI222_X2", 13, 150, 0.4e-12, false},
+    {CellType::AOI22_X2, "AOI22_X2", 13, 175, 0.45e-12, false},
+    {CellType::CLKBUF_X1, "CLKBUF_X1", 3, 200, 0.5e-12, false},
+    {CellType::CLKBUF_X2, "CLKBUF_X2", 2, 100, 0.3e-12, false},
+    {CellType::DFFR_X1, "DFFR_X1", -1, 125, 0.35e-12, true},
+    {CellType::DFFR_X2, "DFFR_X2", -1, 150, 0.4e-12, true},
+    {CellType::DFFS_X2, "DFFS_X2", -1, 175, 0.45e-12, true},
+    {CellType::DFF_X1, "DFF_X1", -1, 200, 0.5e-12, true},
+    {CellType::DFF_X2, "DFF_X2", -1, 100, 0.3e-12, true},
+    {CellType::HA_X1, "HA_X1", 15, 125, 0.35e-12, false},
+    {CellType::INV_X1, "INV_X1", 5, 150, 0.4e-12, false},
+    {CellType::INV_X16, "INV_X16", 2, 175, 0.45e-12, false},
+    {CellType::INV_X2, "INV_X2", 4, 200, 0.5e-12, false},
+    {CellType::INV_X32, "INV_X32", 1, 100, 0.3e-12, false},
+    {CellType::INV_X4, "INV_X4", 3, 125, 0.35e-12, false},
+    {CellType::INV_X8, "INV_X8", 2, 150, 0.4e-12, false},
+    {CellType::MUX2_X1, "MUX2_X1", 14, 175, 0.45e-12, false},
+    {CellType::NAND2_X1, "NAND2_X1", 10, 200, 0.5e-12, false},
+    {CellType::NAND2_X2, "NAND2_X2", 9, 100, 0.3e-12, false},
+    {CellType::NAND2_X4, "NAND2_X4", 8, 125, 0.35e-12, false},
+    {CellType::NAND3_X2, "NAND3_X2", 11, 150, 0.4e-12, false},
+    {CellType::NAND3_X4, "NAND3_X4", 10, 175, 0.45e-12, false},
+    {CellType::NAND4_X2, "NAND4_X2", 13, 200, 0.5e-12, false},
+    {CellType::NOR2_X2, "NOR2_X2", 9, 100, 0.3e-12, false},
+    {CellType::NOR2_X4, "NOR2_X4", 8, 125, 0.35e-12, false},
+    {CellType::NOR3_X2, "NOR3_X2", 10, 150, 0.4e-12, false},
+    {CellType::NOR3_X4, "NOR3_X4", 9, 175, 0.45e-12, false},
+    {CellType::NOR4_X2, "NOR4_X2", 12, 200, 0.5e-12, false},
+    {CellType::OAI211_X2, "OAI211_X2", 13, 100, 0.3e-12, false},
+    {CellType::OAI21_X2, "OAI21_X2", 12, 125, 0.35e-12, false},
+    {CellType::OAI221_X2, "OAI221_X2", 14, 150, 0.4e-12, false},
+    {CellType::OAI222_X2, "OAI222_X2", 14, 175, 0.45e-12, false},
+    {CellType::OAI22_X1, "OAI22_X1", 13, 200, 0.5e-12, false},
+    {CellType::OAI22_X2, "OAI22_X2", 12, 100, 0.3e-12, false},
+    {CellType::OR2_X2, "OR2_X2", 8, 125, 0.35e-12, false},
+    {CellType::OR2_X4, "OR2_X4", 7, 150, 0.4e-12, false},
+    {CellType::SDFFR_X2, "SDFFR_X2", -1, 175, 0.45e-12, true},
+    {CellType::SDFF_X2, "SDFF_X2", -1, 200, 0.5e-12, true},
+    {CellType::XNOR2_X2, "XNOR2_X2", 12, 100, 0.3e-12, false},
+    {CellType::XOR2_X2, "XOR2_X2", 12, 125, 0.35e-12, false},
+};
+
+inline constexpr size_t NUM_CELL_TYPES = sizeof(CELL_LIBRARY) / sizeof(CELL_LIBRARY[0]);
+
+constexpr bool cell_library_in_enum_order()
+{
+    for (size_t i = 0; i < NUM_CELL_TYPES; ++i)
+    {
+        if (static_cast<size_t>(CELL_LIBRARY[i].type) != i)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(cell_library_in_enum_order(), "CELL_LIBRARY must list every CellType in enum order");
+
+constexpr const CellSpec &cell_spec(CellType type)
+{
+    return static_cast<size_t>(type) < NUM_CELL_TYPES ? CELL_LIBRARY[static_cast<size_t>(type)] : CELL_LIBRARY[0];
+}
+
+// Cell names in byte order for a binary search
+struct CellName
+{
+    std::string_view name;
+    CellType type;
+};
+
+inline constexpr CellName CELL_NAMES[] = {
+    {"$_AND_", CellType::AND},
+    {"$_DFF_PN0_", CellType::DFF_PN0},
+    {"$_DFF_P_", CellType::DFF_P},
+    {"$_MUX_", CellType::MUX},
+    {"$_NAND_", CellType::NAND},
+    {"$_NOR_", CellType::NOR},
+    {"$_NOT_", CellType::NOT},
+    {"$_OR_", CellType::OR},
+    {"$_XNOR_", CellType::XNOR},
+    {"$_XOR_", CellType::XOR},
+    {"AND2_X2", CellType::AND2_X2},
+    {"AND2_X4", CellType::AND2_X4},
+    {"AND3_X2", CellType::AND3_X2},
+    {"AND3_X4", CellType::AND3_X4},
+    {"AND4_X2", CellType::AND4_X2},
+    {"AND4_X4", CellType::AND4_X4},
+    {"AOI211_X2", CellType::AOI211_X2},
+    {"AOI21_X2", CellType::AOI21_X2},
+    {"AOI21_X4", CellType::AOI21_X4},
+    {"AOI221_X2", CellType::AOI221_X2},
+    {"AOI222_X1", CellType::AOI222_X1},
+    {"AOI222_X2", CellType::AOI222_X2},
+    {"AOI22_X2", CellType::AOI22_X2},
+    {"CLKBUF_X1", CellType::CLKBUF_X1},
+    {"CLKBUF_X2", CellType::CLKBUF_X2},
+    {"DFFR_X1", CellType::DFFR_X1},
+    {"DFFR_X2", CellType::DFFR_X2},
+    {"DFFS_X2", CellType::DFFS_X2},
+    {"DFF_X1", CellType::DFF_X1},
+    {"DFF_X2", CellType::DFF_X2},
+    {"HA_X1", CellType::HA_X1},
+    {"INV_X1", CellType::INV_X1},
+    {"INV_X16", CellType::INV_X16},
+    {"INV_X2", CellType::INV_X2},
+    {"INV_X32", CellType::INV_X32},
+    {"INV_X4", CellType::INV_X4},
+    {"INV_X8", CellType::INV_X8},
+    {"MUX2_X1", CellType::MUX2_X1},
+    {"NAND2_X1", CellType::NAND2_X1},
+    {"NAND2_X2", CellType::NAND2_X2},
+    {"NAND2_X4", CellType::NAND2_X4},
+    {"NAND3_X2", CellType::NAND3_X2},
+    {"NAND3_X4", CellType::NAND3_X4},
+    {"NAND4_X2", CellType::NAND4_X2},
+    {"NOR2_X2", CellType::NOR2_X2},
+    {"NOR2_X4", CellType::NOR2_X4},
+    {"NOR3_X2", CellType::NOR3_X2},
+    {"NOR3_X4", CellType::NOR3_X4},
+    {"NOR4_X2", CellType::NOR4_X2},
+    {"OAI211_X2", CellType::OAI211_X2},
+    {"OAI21_X2", CellType::OAI21_X2},
+    {"OAI221_X2", CellType::OAI221_X2},
+    {"OAI222_X2", CellType::OAI222_X2},
+    {"OAI22_X1", CellType::OAI22_X1},
+    {"OAI22_X2", CellType::OAI22_X2},
+    {"OR2_X2", CellType::OR2_X2},
+    {"OR2_X4", CellType::OR2_X4},
+    {"SDFFR_X2", CellType::SDFFR_X2},
+    {"SDFF_X2", CellType::SDFF_X2},
+    {"XNOR2_X2", CellType::XNOR2_X2},
+    {"XOR2_X2", CellType::XOR2_X2},
+};
+
+inline constexpr size_t NUM_CELL_NAMES = sizeof(CELL_NAMES) / sizeof(CELL_NAMES[0]);
+
+constexpr bool cell_names_sorted()
+{
+    for (size_t i = 1; i < NUM_CELL_NAMES; ++i)
+    {
+        if (!(CELL_NAMES[i - 1].name < CELL_NAMES[i].name) || cell_spec(CELL_NAMES[i].type).name != CELL_NAMES[i].name)
+        {
+            return false;
+        }
+    }
+    return NUM_CELL_NAMES == NUM_CELL_TYPES - 1; // every type but UNKNOWN has a name
+}
+static_assert(cell_names_sorted(), "CELL_NAMES must be sorted and match CELL_LIBRARY");
+
+constexpr CellType cell_type_from_name(std::string_view name)
+{
+    size_t lo = 0;
+    size_t hi = NUM_CELL_NAMES;
+    while (lo < hi)
+    {
+        size_t mid = (lo + hi) / 2;
+        if (CELL_NAMES[mid].name < name)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo < NUM_CELL_NAMES && CELL_NAMES[lo].name == name ? CELL_NAMES[lo].type : CellType::UNKNOWN;
+}
+static_assert(cell_type_from_name("$_NOT_") == CellType::NOT && cell_type_from_name("XOR2_X2") == CellType::XOR2_X2 &&
+                  cell_type_from_name("$_FOO_") == CellType::UNKNOWN,
+              "cell name lookup");
+
+// Role of a register input pin. Only data pins end timing paths: clocks launch them, and
+// asynchronous set/reset and scan pins are not checked against the clock period.
+enum class PinRole
+{
+    OTHER,
+    DATA,  // D, and E of enable flops
+    CLOCK, // C, CK, CLK
+    ASYNC, // set and reset, either polarity
+    SCAN   // scan enable and scan input
+};
+
+struct PinRoleName
+{
+    std::string_view name;
+    PinRole role;
+};
+
+// Register pin names used by the Yosys internal cells and the mapped library, in byte order
+inline constexpr PinRoleName PIN_ROLES[] = {
+    {"C", PinRole::CLOCK},
+    {"CK", PinRole::CLOCK},
+    {"CLK", PinRole::CLOCK},
+    {"D", PinRole::DATA},
+    {"E", PinRole::DATA},
+    {"R", PinRole::ASYNC},
+    {"RN", PinRole::ASYNC},
+    {"S", PinRole::ASYNC},
+    {"SE", PinRole::SCAN},
+    {"SI", PinRole::SCAN},
+    {"SN", PinRole::ASYNC},
+};
+
+inline constexpr size_t NUM_PIN_ROLES = sizeof(PIN_ROLES) / sizeof(PIN_ROLES[0]);
+
+constexpr bool pin_roles_sorted()
+{
+    for (size_t i = 1; i < NUM_PIN_ROLES; ++i)
+    {
+        if (!(PIN_ROLES[i - 1].name < PIN_ROLES[i].name))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(pin_roles_sorted(), "PIN_ROLES must be sorted by name");
+
+constexpr PinRole pin_role(std::string_view pin)
+{
+    size_t lo = 0;
+    size_t hi = NUM_PIN_ROLES;
+    while (lo < hi)
+    {
+        size_t mid = (lo + hi) / 2;
+        if (PIN_ROLES[mid].name < pin)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo < NUM_PIN_ROLES && PIN_ROLES[lo].name == pin ? PIN_ROLES[lo].role : PinRole::OTHER;
+}
+static_assert(pin_role("CK") == PinRole::CLOCK && pin_role("D") == PinRole::DATA && pin_role("SE") == PinRole::SCAN &&
+                  pin_role("RN") == PinRole::ASYNC && pin_role("Q") == PinRole::OTHER,
+              "pin role lookup");
+
+#endif // CELL_LIBRARY_HPP
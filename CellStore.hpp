@@ -0,0 +1,29 @@
+#ifndef CELL_STORE_HPP
+#define CELL_STORE_HPP
+
+#include <vector>
+#include "Cell.hpp"
+
+// Structure-of-arrays cell table indexed by a dense cell index. The timing kernels touch only the
+// arrays they need, and a Yosys bit (the id of the cell it drives) maps to its cell in O(1).
+struct CellStore
+{
+    std::vector<int> id;
+    std::vector<CellType> type;
+    std::vector<double> delay;
+    std::vector<double> resistance;
+    std::vector<double> capacitance;
+
+    // Pins in CSR form: inputs of cell c are pins[pinOffsets[c] .. outputOffsets[c]),
+    // outputs are pins[outputOffsets[c] .. pinOffsets[c + 1])
+    std::vector<int> pinOffsets;
+    std::vector<int> outputOffsets;
+    std::vector<int> pins;
+
+    std::vector<int> bitToCell; // Yosys bit -> cell index, -1 if no cell has that id
+
+    int size() const { return static_cast<int>(id.size()); }
+    int find(int bit) const { return bit >= 0 && bit < static_cast<int>(bitToCell.size()) ? bitToCell[bit] : -1; }
+};
+
+#endif // CELL_STORE_HPP
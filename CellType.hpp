@@ -1,3 +1,6 @@
+#ifndef CELLTYPE_HPP
+#define CELLTYPE_HPP
+
 #include <map>
 #include <string>
 #include <unordered_map>
@@ -30,4 +33,6 @@ enum class CellType {
     OR2_X2, OR2_X4,
     SDFFR_X2, SDFF_X2,
     XNOR2_X2, XOR2_X2
-};
\ No newline at end of file
+};
+
+#endif // CELLTYPE_HPP
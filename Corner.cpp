@@ -0,0 +1,61 @@
+#include <fstream>
+#include <sstream>
+#include "Corner.hpp"
+#include "DAG.hpp"
+
+Corner nominal_corner()
+{
+    return {"nominal", 1.0, 1.0, 1.0, CLOCK_PERIOD, SETUP_TIME};
+}
+
+bool load_corners(const std::string &path, std::vector<Corner> &corners, std::string &error)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    corners.clear();
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line))
+    {
+        ++line_number;
+        std::istringstream fields(line);
+        Corner corner = nominal_corner();
+        if (!(fields >> corner.name) || corner.name[0] == '#')
+        {
+            continue;
+        }
+        if (!(fields >> corner.resistance_scale >> corner.capacitance_scale >> corner.delay_scale))
+        {
+            error = path + ":" + std::to_string(line_number) + ": expected name r_scale c_scale delay_scale";
+            return false;
+        }
+        double value;
+        if (fields >> value)
+        {
+            corner.clock_period = value;
+            if (fields >> value)
+            {
+                corner.setup_time = value;
+            }
+        }
+
+        if (static_cast<int>(corners.size()) == CORNER_LANES)
+        {
+            error = path + ": more than " + std::to_string(CORNER_LANES) + " corners";
+            return false;
+        }
+        corners.push_back(corner);
+    }
+
+    if (corners.empty())
+    {
+        error = path + ": no corners";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,35 @@
+#ifndef CORNER_HPP
+#define CORNER_HPP
+
+#include <string>
+#include <vector>
+
+// A process/voltage/temperature corner: derating factors applied to the cell library
+// plus the clock constraints the corner is signed off at
+struct Corner
+{
+    std::string name;
+    double resistance_scale;
+    double capacitance_scale;
+    double delay_scale;
+    double clock_period;
+    double setup_time;
+};
+
+// Every node carries one lane per corner so the kernels handle all corners in one pass.
+// Analyses with fewer corners fill the spare lanes with the last corner.
+constexpr int CORNER_LANES = 8;
+
+struct alignas(32) CornerTimes
+{
+    float lane[CORNER_LANES];
+};
+
+// The single corner the scalar engine analyzes (no derating, CLOCK_PERIOD / SETUP_TIME)
+Corner nominal_corner();
+
+// Reads one corner per line: name r_scale c_scale delay_scale [clock_period [setup_time]].
+// Blank lines and lines starting with '#' are ignored.
+bool load_corners(const std::string &path, std::vector<Corner> &corners, std::string &error);
+
+#endif // CORNER_HPP
@@ -1,103 +1,296 @@
 #include "DAG.hpp"
 #include <iostream>
 #include <chrono>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+#include <functional>
+
+// Lock-free max/min on a float via a compare-and-swap loop
+static inline void atomicMax(std::atomic<float> &target, float value)
+{
+    float current = target.load(std::memory_order_relaxed);
+    while (current < value && !target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+static inline void atomicMin(std::atomic<float> &target, float value)
+{
+    float current = target.load(std::memory_order_relaxed);
+    while (current > value && !target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+static std::string netName(const ASIC &asic, int net)
+{
+    auto it = asic.net_dict.find(net);
+    return std::string(it != asic.net_dict.end() ? it->second : "Unknown");
+}
+
+// Returns the dense index of a Yosys bit, creating the node on first use
+int DAG::addNode(int bit)
+{
+    if (bit >= static_cast<int>(bitToIndex.size()))
+    {
+        bitToIndex.resize(bit + 1, -1);
+    }
+    if (bitToIndex[bit] < 0)
+    {
+        bitToIndex[bit] = static_cast<int>(nodeIds.size());
+        nodeIds.push_back(bit);
+    }
+    return bitToIndex[bit];
+}
 
 // Adds a directed edge from 'from' to 'to'
 void DAG::addEdge(int from, int to)
 {
-    adjList[from].push_back(to);
+    edgeList.emplace_back(addNode(from), addNode(to));
 }
 
-void DAG::createTaskGraph(const ASIC &asic)
+// Turns the staged edge list into the fanout CSR, keeping per-node insertion order
+void DAG::buildFanoutCSR()
 {
-    // reverseList();
-    for (const auto &[node, neighbors] : adjList)
+    const int n = numNodes();
+    fanoutOffsets.assign(n + 1, 0);
+    for (const auto &[from, to] : edgeList)
+    {
+        fanoutOffsets[from + 1]++;
+    }
+    for (int u = 0; u < n; ++u)
     {
-        std::string rc = std::to_string(node) + "_rc";
-        std::string slew = std::to_string(node) + "_slew";
-        std::string arrival = std::to_string(node) + "_arrival";
+        fanoutOffsets[u + 1] += fanoutOffsets[u];
+    }
+
+    fanoutTargets.resize(edgeList.size());
+    std::vector<int> cursor(fanoutOffsets.begin(), fanoutOffsets.end() - 1);
+    for (const auto &[from, to] : edgeList)
+    {
+        fanoutTargets[cursor[from]++] = to;
+    }
+    edgeList.clear();
+    edgeList.shrink_to_fit();
+
+    edge_rc.assign(fanoutTargets.size(), 0.0);
+    edge_slew.assign(fanoutTargets.size(), 0.0);
+}
+
+void DAG::setThreads(int num_threads, bool pin)
+{
+    executor = TaskExecutor(num_threads, pin);
+    omp_set_num_threads(executor.numThreads());
+    LOG_INFO("Threads: " << executor.numThreads() << (pin ? " (pinned)" : ""));
+}
 
-        taskGraph[rc].push_back(slew);      // rc -> slew
-        taskGraph[slew].push_back(arrival); // slew -> arrival
+// Sizes the timing arrays to the node count and resets them
+void DAG::initTimingArrays()
+{
+    partitionRegions();
+    arrival_time = FirstTouchVector<std::atomic<float>>(numNodes());
+    early_arrival_time = FirstTouchVector<std::atomic<float>>(numNodes());
+    required_time = FirstTouchVector<std::atomic<float>>(numNodes());
+    edge_rc = FirstTouchVector<double>(numEdges());
+    edge_slew = FirstTouchVector<double>(numEdges());
+
+    // The pages of a region land on the NUMA node of the worker that owns it
+    executor.forEachWorker([&](int region)
+    {
+        for (int i = regionOffsets[region]; i < regionOffsets[region + 1]; ++i)
+        {
+            arrival_time[i].store(0.0f, std::memory_order_relaxed);
+            early_arrival_time[i].store(std::numeric_limits<float>::infinity(), std::memory_order_relaxed);
+            required_time[i].store(std::numeric_limits<float>::infinity(), std::memory_order_relaxed);
+        }
+        for (int e = fanoutOffsets[regionOffsets[region]]; e < fanoutOffsets[regionOffsets[region + 1]]; ++e)
+        {
+            edge_rc[e] = 0.0;
+            edge_slew[e] = 0.0;
+        }
+    });
+}
 
-        for (int neighbor : neighbors)
+// Cuts the node index range into one region per worker with about the same number of
+// nodes plus fanout edges each, and reports at debug level how many edges cross between regions
+void DAG::partitionRegions()
+{
+    const int n = numNodes();
+    const int regions = executor.numThreads();
+    const long total = static_cast<long>(n) + numEdges();
+
+    regionOffsets.assign(regions + 1, n);
+    regionOffsets[0] = 0;
+    nodeRegion.resize(n);
+    int region = 0;
+    for (int node = 0; node < n; ++node)
+    {
+        // Work done before this node, in nodes plus edges
+        long before = node + fanoutOffsets[node];
+        while (region + 1 < regions && before >= total * (region + 1) / regions)
         {
-            std::string neighbor_rc = std::to_string(neighbor) + "_rc";
-            taskGraph[arrival].push_back(neighbor_rc); // arrival -> fanout rc
+            regionOffsets[++region] = node;
         }
+        nodeRegion[node] = region;
     }
 
-    // After all forward pass is complete, handle backward pass starting from outputs
-    for (int outputNode : asic.outputs)
+    if (!LOG_ENABLED(LOG_LEVEL_DEBUG))
     {
-        std::string output_arrival = std::to_string(outputNode) + "_arrival";
-        std::string output_be_required = std::to_string(outputNode) + "_be_required";
-
-        // Link arrival to be_required
-        taskGraph[output_arrival].push_back(output_be_required);
+        return;
+    }
+    long cut = 0;
+    for (int node = 0; node < n; ++node)
+    {
+        for (int e = fanoutOffsets[node]; e < fanoutOffsets[node + 1]; ++e)
+        {
+            cut += nodeRegion[fanoutTargets[e]] != nodeRegion[node];
+        }
+    }
+    LOG_DEBUG("Partitioned " << n << " nodes into " << regions << " regions; " << cut << " of " << numEdges()
+                            << " edges cross regions (" << (numEdges() ? 100.0 * cut / numEdges() : 0.0) << "%)");
+}
 
-        // Now propagate be_required backwards to fan-ins
-        std::queue<int> q;
-        std::unordered_set<int> visited;
+void DAG::reportNumaStats(const char *pass) const
+{
+    const TaskExecutor::Stats &stats = executor.stats;
+    LOG_INFO(pass << ": " << stats.remote << " of " << stats.tasks << " tasks ran off their region's NUMA node ("
+                  << (stats.tasks ? 100.0 * stats.remote / stats.tasks : 0.0) << "% remote, "
+                  << numa_node_count() << " node" << (numa_node_count() > 1 ? "s" : "") << ")");
+}
 
-        // Start with the output node
-        q.push(outputNode);
-        visited.insert(outputNode);
+void DAG::createTaskGraph(const ASIC &asic)
+{
+    initTimingArrays();
+    buildTaskGraph(asic);
 
-        while (!q.empty())
+    // Register outputs launch at the clock edge plus clock-to-Q
+    for (int index = 0; index < numNodes(); ++index)
+    {
+        if (is_launch[index])
         {
-            int current = q.front();
-            q.pop();
+            arrival_time[index].store(CLK2Q_MAX, std::memory_order_relaxed);
+            early_arrival_time[index].store(CLK2Q_MIN, std::memory_order_relaxed);
+        }
+    }
+
+    LOG_INFO("Done creating task graph (forward + backward after outputs)!");
+}
 
-            std::string current_be_required = std::to_string(current) + "_be_required";
+// Builds the task CSR from the fanout and fanin CSRs without touching the timing arrays
+void DAG::buildTaskGraph(const ASIC &asic)
+{
+    // Tasks are plain integers built on the dense node index
+    const int num_tasks = numTasks();
+    is_output.assign(numNodes(), 0);
+    for (int outputNode : asic.outputs)
+    {
+        int index = indexOf(outputNode);
+        if (index >= 0)
+        {
+            is_output[index] = 1;
+        }
+    }
 
-            for (int fanin : reverseAdjList[current])
+    is_launch.assign(numNodes(), 0);
+    is_capture.assign(numNodes(), 0);
+    for (const auto &cell : asic.cells)
+    {
+        if (!is_sequential(cell.type))
+        {
+            continue;
+        }
+        for (int bit : cell.outputs)
+        {
+            if (indexOf(bit) >= 0)
             {
-                if (!visited.count(fanin))
-                {
-                    std::string fanin_be_required = std::to_string(fanin) + "_be_required";
-                    std::cout << "    Adding fanin " << fanin << " to queue" << std::endl;
+                is_launch[indexOf(bit)] = 1;
+            }
+        }
+        for (int bit : cell.data_inputs)
+        {
+            if (indexOf(bit) >= 0)
+            {
+                is_capture[indexOf(bit)] = 1;
+            }
+        }
+    }
 
-                    taskGraph[current_be_required].push_back(fanin_be_required); // Connect be_required to fanins
+    // Pass 1: count successors of every task
+    taskOffsets.assign(num_tasks + 1, 0);
+    for (int index = 0; index < numNodes(); ++index)
+    {
+        if (stagedForward)
+        {
+            taskOffsets[taskId(index, STAGE_RC) + 1] = 1;   // rc -> slew
+            taskOffsets[taskId(index, STAGE_SLEW) + 1] = 1; // slew -> arrival
+        }
+        taskOffsets[taskId(index, STAGE_ARRIVAL) + 1] = fanoutOffsets[index + 1] - fanoutOffsets[index] + isEndpoint(index);
+        taskOffsets[taskId(index, STAGE_BE_REQUIRED) + 1] = faninOffsets[index + 1] - faninOffsets[index];
+    }
+    for (int t = 0; t < num_tasks; ++t)
+    {
+        taskOffsets[t + 1] += taskOffsets[t];
+    }
 
-                    q.push(fanin);
-                    visited.insert(fanin);
-                }
-            }
+    // Pass 2: fill successors
+    const TaskStage first_stage = stagedForward ? STAGE_RC : STAGE_ARRIVAL;
+    taskTargets.resize(taskOffsets[num_tasks]);
+    for (int index = 0; index < numNodes(); ++index)
+    {
+        if (stagedForward)
+        {
+            taskTargets[taskOffsets[taskId(index, STAGE_RC)]] = taskId(index, STAGE_SLEW);
+            taskTargets[taskOffsets[taskId(index, STAGE_SLEW)]] = taskId(index, STAGE_ARRIVAL);
+        }
 
-            if (q.empty())
-            {
-                int next = current - 1;
+        // arrival -> first forward stage of the fanout, and arrival -> be_required for endpoints
+        int pos = taskOffsets[taskId(index, STAGE_ARRIVAL)];
+        for (int e = fanoutOffsets[index]; e < fanoutOffsets[index + 1]; ++e)
+        {
+            taskTargets[pos++] = taskId(fanoutTargets[e], first_stage);
+        }
+        if (isEndpoint(index))
+        {
+            taskTargets[pos++] = taskId(index, STAGE_BE_REQUIRED);
+        }
 
-                if (reverseAdjList.find(next) != reverseAdjList.end())
-                {
-                    q.push(next);
-                    visited.insert(next);
-                }
-            }
+        // be_required -> fanin be_required, so a node's required time is final before it propagates
+        pos = taskOffsets[taskId(index, STAGE_BE_REQUIRED)];
+        for (int i = faninOffsets[index]; i < faninOffsets[index + 1]; ++i)
+        {
+            taskTargets[pos++] = taskId(faninSources[i], STAGE_BE_REQUIRED);
         }
     }
 
-    std::cout << "Done creating task graph (forward + backward after outputs)!" << std::endl;
+    taskInDegree.assign(num_tasks, 0);
+    for (int target : taskTargets)
+    {
+        taskInDegree[target]++;
+    }
+}
 
-    // Forward pass: rc -> slew -> arrival -> fanout rc
+std::string DAG::taskName(int task) const
+{
+    static const char *stage_names[NUM_STAGES] = {"rc", "slew", "arrival", "be_required"};
+    TaskStage stage = taskStage(task);
+    return std::to_string(nodeIds[taskNode(task)]) + "_" + (stage == STAGE_ARRIVAL && !stagedForward ? "forward" : stage_names[stage]);
 }
 
 void DAG::printTaskGraph()
 {
     std::cout << "Task Graph Dependencies (DAG):\n";
-    for (const auto &[task, dependents] : taskGraph)
+    for (int task = 0; task < numTasks(); ++task)
     {
-        std::cout << task << " -> ";
-        if (dependents.empty())
+        std::cout << taskName(task) << " -> ";
+        if (taskOffsets[task] == taskOffsets[task + 1])
         {
             std::cout << "{}";
         }
         else
         {
-            for (const auto &dep : dependents)
+            for (int i = taskOffsets[task]; i < taskOffsets[task + 1]; ++i)
             {
-                std::cout << dep << " ";
+                std::cout << taskName(taskTargets[i]) << " ";
             }
         }
         std::cout << "\n";
@@ -106,21 +299,28 @@ void DAG::printTaskGraph()
 
 void DAG::displayGraph(const ASIC &asic)
 {
-    for (const auto &node : adjList)
+    for (int u = 0; u < numNodes(); ++u)
     {
+        if (fanoutOffsets[u] == fanoutOffsets[u + 1])
+        {
+            continue;
+        }
+
         // Get the net name from net_dict using the node's ID
-        std::string node_name = (asic.net_dict.find(node.first) != asic.net_dict.end())
-                                    ? asic.net_dict.at(node.first)
-                                    : "Unknown";
+        int node = nodeIds[u];
+        std::string_view node_name = (asic.net_dict.find(node) != asic.net_dict.end())
+                                         ? asic.net_dict.at(node)
+                                         : "Unknown";
 
-        std::cout << "Node " << node_name << " (ID: " << node.first << ") has edges to: ";
+        std::cout << "Node " << node_name << " (ID: " << node << ") has edges to: ";
 
-        for (const auto &neighbor : node.second)
+        for (int e = fanoutOffsets[u]; e < fanoutOffsets[u + 1]; ++e)
         {
             // Get the neighbor's net name from net_dict
-            std::string neighbor_name = (asic.net_dict.find(neighbor) != asic.net_dict.end())
-                                            ? asic.net_dict.at(neighbor)
-                                            : "Unknown";
+            int neighbor = nodeIds[fanoutTargets[e]];
+            std::string_view neighbor_name = (asic.net_dict.find(neighbor) != asic.net_dict.end())
+                                                 ? asic.net_dict.at(neighbor)
+                                                 : "Unknown";
             std::cout << neighbor_name << " (ID: " << neighbor << ") ";
         }
 
@@ -131,8 +331,32 @@ void DAG::displayGraph(const ASIC &asic)
 // Builds the DAG from the ASIC structure (connecting inputs and outputs of cells)
 void DAG::buildFromASIC(const ASIC &asic)
 {
+    // Renumber every bit that takes part in an edge to a dense index, in ascending bit order
+    std::vector<int> bits;
+    for (const auto &cell : asic.cells)
+    {
+        if (cell.inputs.empty() || cell.outputs.empty())
+        {
+            continue;
+        }
+        bits.insert(bits.end(), cell.inputs.begin(), cell.inputs.end());
+        bits.insert(bits.end(), cell.outputs.begin(), cell.outputs.end());
+    }
+    std::sort(bits.begin(), bits.end());
+    bits.erase(std::unique(bits.begin(), bits.end()), bits.end());
+    for (int bit : bits)
+    {
+        addNode(bit);
+    }
+
+    // Registers get no input -> output arcs: their outputs launch new paths and their inputs
+    // end the paths into them, so sequential loops never reach removeCycles
     for (const auto &cell : asic.cells)
     {
+        if (is_sequential(cell.type))
+        {
+            continue;
+        }
         for (const auto &input : cell.inputs)
         {
             for (const auto &output : cell.outputs)
@@ -141,74 +365,244 @@ void DAG::buildFromASIC(const ASIC &asic)
             }
         }
     }
+
+    buildFanoutCSR();
+}
+
+bool DAG::setGraph(std::vector<int> node_ids, std::vector<int> offsets, std::vector<int> targets)
+{
+    // The arrays come from outside (the netlist cache), so they are checked before any of them
+    // is adopted: unique non-negative bits, monotone offsets covering every target, targets in range
+    const int n = static_cast<int>(node_ids.size());
+    if (offsets.size() != node_ids.size() + 1 || offsets[0] != 0 ||
+        static_cast<size_t>(offsets[n]) != targets.size())
+    {
+        return false;
+    }
+    for (int i = 0; i < n; ++i)
+    {
+        if (offsets[i] > offsets[i + 1])
+        {
+            return false;
+        }
+    }
+    for (int target : targets)
+    {
+        if (target < 0 || target >= n)
+        {
+            return false;
+        }
+    }
+
+    std::vector<int> bit_to_index;
+    for (int i = 0; i < n; ++i)
+    {
+        int bit = node_ids[i];
+        if (bit < 0)
+        {
+            return false;
+        }
+        if (bit >= static_cast<int>(bit_to_index.size()))
+        {
+            bit_to_index.resize(static_cast<size_t>(bit) + 1, -1);
+        }
+        if (bit_to_index[bit] != -1)
+        {
+            return false;
+        }
+        bit_to_index[bit] = i;
+    }
+
+    nodeIds = std::move(node_ids);
+    bitToIndex = std::move(bit_to_index);
+    fanoutOffsets = std::move(offsets);
+    fanoutTargets = std::move(targets);
+    edgeList.clear();
+    edge_rc.assign(fanoutTargets.size(), 0.0);
+    edge_slew.assign(fanoutTargets.size(), 0.0);
+    return true;
 }
 
-void DAG::removeCycles()
+// Iterative DFS over the CSR that cuts every back edge (an edge into a node still on the DFS
+// path) and, with Tarjan's lowlinks, groups the cuts by strongly connected component so each
+// feedback loop is reported once. Linear time; all state lives in per-node arrays.
+std::vector<DAG::FeedbackLoop> DAG::removeCycles()
 {
-    std::unordered_set<int> visited;
-    std::unordered_set<int> recStack;
+    enum : char
+    {
+        WHITE, // not visited
+        GRAY,  // on the DFS path
+        BLACK  // finished
+    };
+
+    const int n = numNodes();
+    std::vector<char> color(n, WHITE);
+    std::vector<char> on_stack(n, 0);
+    std::vector<int> order(n, 0);
+    std::vector<int> lowlink(n, 0);
+    std::vector<int> component(n, -1);
+    std::vector<int> scc_stack;
+    std::vector<std::pair<int, int>> path; // node, next fanout edge to look at
+    std::vector<int> cut;                  // edge ids of the back edges
+    std::vector<char> removed(numEdges(), 0);
+    scc_stack.reserve(n);
+    path.reserve(n);
+    int counter = 0;
+    int components = 0;
+
+    auto enter = [&](int node)
+    {
+        color[node] = GRAY;
+        order[node] = lowlink[node] = counter++;
+        scc_stack.push_back(node);
+        on_stack[node] = 1;
+        path.emplace_back(node, fanoutOffsets[node]);
+    };
 
-    std::function<void(int)> dfs = [&](int node)
+    for (int root = 0; root < n; ++root)
     {
-        visited.insert(node);
-        recStack.insert(node);
+        if (color[root] != WHITE)
+        {
+            continue;
+        }
+        enter(root);
 
-        auto &neighbors = adjList[node]; // direct reference to the neighbor set
-        for (auto it = neighbors.begin(); it != neighbors.end();)
+        while (!path.empty())
         {
-            int neighbor = *it;
+            int node = path.back().first;
+            int e = path.back().second;
 
-            if (recStack.count(neighbor))
+            if (e < fanoutOffsets[node + 1])
             {
-                std::cout << "Removing back edge: " << node << " -> " << neighbor << "\n";
-                it = neighbors.erase(it);
+                path.back().second++;
+                int neighbor = fanoutTargets[e];
+                if (color[neighbor] == GRAY)
+                {
+                    removed[e] = 1;
+                    cut.push_back(e);
+                    lowlink[node] = std::min(lowlink[node], order[neighbor]);
+                }
+                else if (color[neighbor] == WHITE)
+                {
+                    enter(neighbor);
+                }
+                else if (on_stack[neighbor])
+                {
+                    lowlink[node] = std::min(lowlink[node], order[neighbor]);
+                }
+                continue;
             }
-            else if (!visited.count(neighbor))
+
+            color[node] = BLACK;
+            path.pop_back();
+            if (!path.empty())
             {
-                dfs(neighbor);
-                ++it;
+                int parent = path.back().first;
+                lowlink[parent] = std::min(lowlink[parent], lowlink[node]);
             }
-            else
+
+            if (lowlink[node] == order[node])
             {
-                ++it;
+                int member;
+                do
+                {
+                    member = scc_stack.back();
+                    scc_stack.pop_back();
+                    on_stack[member] = 0;
+                    component[member] = components;
+                } while (member != node);
+                ++components;
             }
         }
+    }
 
-        recStack.erase(node);
-    };
+    if (cut.empty())
+    {
+        return {};
+    }
+
+    // Every loop holds at least one back edge, so the components with cuts are the loops
+    std::vector<int> loop_of(components, -1);
+    std::vector<FeedbackLoop> loops;
+    for (int e : cut)
+    {
+        int from = std::upper_bound(fanoutOffsets.begin(), fanoutOffsets.end(), e) - fanoutOffsets.begin() - 1;
+        int c = component[from];
+        if (loop_of[c] < 0)
+        {
+            loop_of[c] = static_cast<int>(loops.size());
+            loops.emplace_back();
+        }
+        loops[loop_of[c]].cut_edges.emplace_back(nodeIds[from], nodeIds[fanoutTargets[e]]);
+    }
+    for (int node = 0; node < n; ++node)
+    {
+        if (loop_of[component[node]] >= 0)
+        {
+            loops[loop_of[component[node]]].nodes.push_back(nodeIds[node]);
+        }
+    }
+
+    for (const FeedbackLoop &loop : loops)
+    {
+        LOG_INFO("Feedback loop of " << loop.nodes.size() << " node(s), cutting " << loop.cut_edges.size() << " edge(s)");
+        for (const auto &[from, to] : loop.cut_edges)
+        {
+            LOG_INFO("Removing back edge: " << from << " -> " << to);
+        }
+        if (LOG_ENABLED(LOG_LEVEL_DEBUG))
+        {
+            std::ostringstream members;
+            for (int bit : loop.nodes)
+            {
+                members << " " << bit;
+            }
+            LOG_DEBUG("  Loop nodes:" << members.str());
+        }
+    }
 
-    for (const auto &[node, _] : adjList)
+    // Compact the CSR, dropping the back edges
+    int write = 0;
+    for (int u = 0; u < n; ++u)
     {
-        if (!visited.count(node))
+        int begin = fanoutOffsets[u];
+        fanoutOffsets[u] = write;
+        for (int e = begin; e < fanoutOffsets[u + 1]; ++e)
         {
-            dfs(node);
+            if (!removed[e])
+            {
+                fanoutTargets[write++] = fanoutTargets[e];
+            }
         }
     }
+    fanoutOffsets[n] = write;
+    fanoutTargets.resize(write);
+    edge_rc.assign(write, 0.0);
+    edge_slew.assign(write, 0.0);
+
+    return loops;
 }
 
-std::vector<int> DAG::topologicalSort(const ASIC &asic, const std::map<int, Cell> &cell_map)
+std::vector<int> DAG::topologicalSort(const CellStore &cells)
 {
-    std::unordered_map<int, int> inDegree;
+    std::vector<int> inDegree(numNodes(), 0);
     std::vector<int> result;
     std::queue<int> q;
 
+    initTimingArrays();
+
     // Calculate in-degrees
-    for (const auto &node : adjList)
+    for (int target : fanoutTargets)
     {
-        inDegree[node.first];
-        for (int neighbor : node.second)
-        {
-            inDegree[neighbor]++;
-        }
+        inDegree[target]++;
     }
 
     // Enqueue nodes with 0 in-degree
-    for (const auto &[node, degree] : inDegree)
+    for (int node = 0; node < numNodes(); ++node)
     {
-        if (degree == 0)
+        if (inDegree[node] == 0)
         {
             q.push(node);
-            arrival_time[node] = 0;
         }
     }
 
@@ -217,19 +611,22 @@ std::vector<int> DAG::topologicalSort(const ASIC &asic, const std::map<int, Cell
     {
         int current = q.front();
         q.pop();
-        result.push_back(current);
+        result.push_back(nodeIds[current]);
 
-        for (int neighbor : adjList[current])
+        for (int e = fanoutOffsets[current]; e < fanoutOffsets[current + 1]; ++e)
         {
-            if (cell_map.find(current) != cell_map.end() && cell_map.find(neighbor) != cell_map.end())
+            int neighbor = fanoutTargets[e];
+            int current_cell = cells.find(nodeIds[current]);
+            int neighbor_cell = cells.find(nodeIds[neighbor]);
+            if (current_cell >= 0 && neighbor_cell >= 0)
             {
-                double rc_delay = computeRCDelay(cell_map.at(current), cell_map.at(neighbor), current, neighbor);
-                double slew_rate = computeSlewRate(cell_map.at(current), cell_map.at(neighbor), current, neighbor);
-                updateArrivalTime(current, neighbor, cell_map);
+                computeRCDelay(cells, current_cell, neighbor_cell, e);
+                computeSlewRate(cells, current_cell, neighbor_cell, e);
+                updateArrivalTime(current, neighbor, e, cells);
             }
             else
             {
-                std::cerr << "These are signals - don't correspond to components" << std::endl;
+                LOG_TRACE("These are signals - don't correspond to components");
             }
             inDegree[neighbor]--;
             if (inDegree[neighbor] == 0)
@@ -242,539 +639,1377 @@ std::vector<int> DAG::topologicalSort(const ASIC &asic, const std::map<int, Cell
     return result;
 }
 
-std::vector<int> DAG::topological_TaskGraph(DAG &dag, const std::map<int, Cell> &cell_map, const ASIC &asic)
+std::vector<int> DAG::topological_TaskGraph(DAG &dag, const CellStore &cells, const ASIC &asic)
 {
-    std::map<std::string, int> inDegree;
-    std::vector<int> result;
-    std::vector<std::string> q;
-
-    if (verbose)
-    {
-        std::cout << "\n=== Step 1: Calculating in-degrees (TaskGraph) ===\n";
-    }
-
-    for (const auto &[task, deps] : taskGraph)
-    {
-        if (!inDegree.count(task))
-            inDegree[task] = 0;
-        for (const std::string &dep : deps)
-        {
-            if (!inDegree.count(dep))
-                inDegree[dep] = 0;
-            inDegree[dep]++;
-
-            if (verbose)
-            {
-                std::cout << "Edge: " << task << " -> " << dep
-                          << " | Incrementing in-degree of " << dep
-                          << " to " << inDegree[dep] << "\n";
-            }
-        }
-    }
-
-    if (verbose)
-    {
-        std::cout << "\n=== Step 2: Enqueuing in-degree 0 tasks ===\n";
-    }
+    // Nodes are recorded in the order their arrival task completes
+    std::vector<int> result(nodeIds.size());
+    std::atomic<int> result_size{0};
 
-    for (const auto &[task, deg] : inDegree)
+    if (LOG_ENABLED(LOG_LEVEL_TRACE))
     {
-        if (deg == 0)
+        LOG_TRACE("\n=== Step 1: Task in-degrees (TaskGraph) ===");
+        for (int task = 0; task < numTasks(); ++task)
         {
-            q.push_back(task);
-            if (verbose)
-            {
-                std::cout << "TID: " << omp_get_thread_num()
-                          << " | Enqueued initial task: " << task
-                          << " with in-degree = 0\n";
-            }
+            LOG_TRACE("Task " << taskName(task) << " has in-degree " << taskInDegree[task]);
         }
+        LOG_TRACE("\n=== Step 2: Processing task graph (work stealing) ===");
     }
 
-    if (verbose)
-    {
-        std::cout << "\n=== Step 3: Processing task queue (parallel) ===\n";
-    }
-
-    while (!q.empty())
+    auto run = [&](int task, int tid)
     {
-        std::vector<std::string> next_q;
-        std::vector<std::string> q_copy = q;
+        LOG_TRACE("TID " << tid << " | Processing task: " << taskName(task)
+                          << " | Cell ID: " << nodeIds[taskNode(task)]);
 
-        if (verbose)
-        {
-            std::cout << "\n-- New Iteration with " << q_copy.size() << " tasks in queue --\n";
-            for (const auto &task : q_copy)
-            {
-                std::cout << "Task in queue: " << task << "\n";
-            }
-        }
+        dag.processQueue(task, dag, cells, asic);
 
-#pragma omp parallel num_threads(8)
+        if (taskStage(task) == STAGE_ARRIVAL)
         {
-            std::vector<std::string> local_next;
-
-#pragma omp for
-            for (int i = 0; i < q_copy.size(); ++i)
-            {
-                std::string current = q_copy[i];
-
-                size_t sep = current.find('_');
-                int cell_id = std::stoi(current.substr(0, sep));
-                string stage = (current.substr(sep + 1));
-
-                if (stage == "arrival")
-                {
-#pragma omp critical
-                    {
-                        result.push_back(cell_id);
-                    }
-                }
-                if (verbose)
-                {
-                    std::cout << "TID " << omp_get_thread_num()
-                              << " | Processing task: " << current
-                              << " | Cell ID: " << cell_id << "\n";
-                }
-
-                dag.processQueue(current, dag, cell_map, asic);
-
-                for (const std::string &neighbor : taskGraph[current])
-                {
-                    int new_in_degree;
-#pragma omp atomic capture
-                    new_in_degree = --inDegree[neighbor];
-
-                    if (verbose)
-                    {
-                        std::cout << "TID " << omp_get_thread_num()
-                                  << " | Processed edge: " << current << " -> " << neighbor
-                                  << " | New in-degree of " << neighbor << " = " << new_in_degree << "\n";
-                    }
-
-                    if (new_in_degree == 0)
-                    {
-                        local_next.push_back(neighbor);
-                        if (verbose)
-                        {
-                            std::cout << "TID " << omp_get_thread_num()
-                                      << " | Enqueuing " << neighbor << " into local next queue\n";
-                        }
-                    }
-                }
-            }
-
-#pragma omp critical
-            {
-                if (verbose)
-                {
-                    std::cout << "TID " << omp_get_thread_num()
-                              << " | Merging " << local_next.size() << " tasks into global next queue\n";
-                }
-                next_q.insert(next_q.end(), local_next.begin(), local_next.end());
-            }
-
-            local_next.clear();
+            result[result_size.fetch_add(1, std::memory_order_relaxed)] = nodeIds[taskNode(task)];
         }
+    };
 
-        if (verbose)
-        {
-            std::cout << "-- End of iteration. Total tasks queued for next round: " << next_q.size() << "\n";
-        }
+    int executed = executor.run(taskOffsets, taskTargets, taskInDegree, run,
+                                [&](int task) { return nodeRegion[taskNode(task)]; });
 
-        q = next_q;
-        next_q.clear();
-    }
+    result.resize(result_size.load());
 
     if (result.empty())
     {
-        std::cerr << "\nError: No tasks processed. Possible cycle in task graph.\n";
+        LOG_ERROR("\nError: No tasks processed. Possible cycle in task graph.");
+        return {};
+    }
+    if (executed < numTasks())
+    {
+        LOG_ERROR("\nError: Only " << executed << " of " << numTasks()
+                                     << " tasks ran. Possible cycle in task graph.");
         return {};
     }
 
-    if (verbose)
+    if (LOG_ENABLED(LOG_LEVEL_TRACE))
     {
-        std::cout << "\n=== Final Task Order (Topologically Sorted) ===\n";
+        LOG_TRACE("\n=== Final Task Order (Topologically Sorted) ===");
         for (int node : result)
         {
-            std::cout << "Cell ID: " << node << "\n";
+            LOG_TRACE("Cell ID: " << node);
         }
     }
 
     return result;
 }
 
-void DAG::processQueue(const std::string &task, DAG &dag, const std::map<int, Cell> &cell_map, const ASIC &asic)
+void DAG::processQueue(int task, DAG &dag, const CellStore &cells, const ASIC &asic)
 {
-
-    size_t sep = task.find('_');
-    if (sep == std::string::npos)
+    int node = taskNode(task);
+    TaskStage stage = taskStage(task);
+    if (stage == STAGE_ARRIVAL && !stagedForward)
     {
-        std::cerr << "Malformed task: " << task << " (missing underscore '_')" << std::endl;
+        dag.propagateForward(node, cells);
         return;
     }
 
-    int cell_id = std::stoi(task.substr(0, sep));
-    std::string stage = task.substr(sep + 1);
+    int cell = cells.find(nodeIds[node]);
 
-    if (stage == "rc")
+    if (stage == STAGE_BE_REQUIRED)
     {
-        for (int neighbor : adjList[cell_id])
+        // Nodes outside every output cone never receive a required time
+        if (cell < 0 || std::isinf(required_time[node].load(std::memory_order_relaxed)))
         {
-            if (cell_map.find((cell_id)) != cell_map.end() && cell_map.find(neighbor) != cell_map.end())
-            {
-                dag.computeRCDelay(cell_map.at(cell_id), cell_map.at(neighbor), cell_id, neighbor);
-            }
+            return;
         }
-        if (verbose)
+        for (int i = faninOffsets[node]; i < faninOffsets[node + 1]; ++i)
         {
-            std::cout << "We are done processing for rc \n";
+            dag.propagateBeRequired(cells.delay[cell], node, faninSources[i], asic);
+            LOG_TRACE("We are PROCESSING FOR TO BE REQUIRED");
         }
+        return;
+    }
+
+    if (cell < 0)
+    {
+        return;
     }
-    else if (stage == "slew")
+
+    // Forward stages: every fanout edge is addressed by its edge id
+    for (int e = fanoutOffsets[node]; e < fanoutOffsets[node + 1]; ++e)
     {
-        for (int neighbor : adjList[cell_id])
+        int neighbor = fanoutTargets[e];
+        int neighbor_cell = cells.find(nodeIds[neighbor]);
+        if (neighbor_cell < 0)
         {
-            if (cell_map.find((cell_id)) != cell_map.end() && cell_map.find(neighbor) != cell_map.end())
-            {
-                dag.computeSlewRate(cell_map.at(cell_id), cell_map.at(neighbor), cell_id, neighbor);
-            }
+            continue;
         }
-        if (verbose)
+
+        if (stage == STAGE_RC)
         {
-            std::cout << "We are done processing for slew \n";
+            dag.computeRCDelay(cells, cell, neighbor_cell, e);
         }
-    }
-    else if (stage == "arrival")
-    {
-
-        for (int neighbor : adjList[cell_id])
+        else if (stage == STAGE_SLEW)
         {
-            if (cell_map.find((cell_id)) != cell_map.end() && cell_map.find(neighbor) != cell_map.end())
-            {
-                dag.updateArrivalTime(cell_id, neighbor, cell_map);
-            }
+            dag.computeSlewRate(cells, cell, neighbor_cell, e);
         }
-        if (verbose)
+        else
         {
-            std::cout << "We are done processing for arrival \n";
+            dag.updateArrivalTime(node, neighbor, e, cells);
         }
     }
-    else if (stage == "be_required")
-    {
-        for (int fanin : reverseAdjList[cell_id])
-        {
-            if (required_time.find(cell_id) == required_time.end())
-            {
-                required_time[cell_id] = INT64_MAX;
-            }
 
-            dag.propagateBeRequired(cell_map.at(cell_id), cell_id, fanin, asic, cell_map);
-            if (verbose)
-            {
-                std::cout << "We are PROCESSING FOR TO BE REQUIRED \n";
-            }
-        }
-    }
-    else
+    static const char *stage_names[] = {"rc", "slew", "arrival"};
+    LOG_TRACE("We are done processing for " << stage_names[stage]);
+}
+
+void DAG::propagateBeRequired(double cell_delay, int current, int fanin, const ASIC &asic)
+{
+    float required_time_for_current = required_time[current].load(std::memory_order_relaxed);
+
+    float required_time_for_fanin = required_time_for_current - cell_delay;
+    atomicMin(required_time[fanin], required_time_for_fanin);
+
+    LOG_TRACE("Fan-in " << netName(asic, nodeIds[fanin]) << " (ID: " << nodeIds[fanin]
+                        << ") → Required time updated to " << required_time[fanin].load()
+                        << " (via " << cell_delay << " delay)");
+}
+
+std::unordered_map<int, float> DAG::computeSlack(const ASIC &asic, const std::vector<int> &sorted)
+{
+    std::unordered_map<int, float> slack;
+
+    LOG_TRACE("\n=== Step 3: Slack Computation ===");
+
+    for (int net : sorted)
     {
-        std::cerr << "Unknown task type: " << task << std::endl;
+        int index = indexOf(net);
+        float at = arrival_time[index].load(std::memory_order_relaxed);
+        float rt = required_time[index].load(std::memory_order_relaxed);
+        if (std::isinf(rt))
+        {
+            rt = CLOCK_PERIOD;
+        }
+
+        float s = rt - at;
+
+        slack[net] = s;
+
+        LOG_TRACE("Net " << netName(asic, net) << " (ID: " << net << ")"
+                         << " | Arrival: " << at
+                         << " | Required: " << rt
+                         << " | Slack: " << s
+                         << (s < 0 ? " VIOLATION!" : s == 0 ? " CRITICAL PATH" : ""));
     }
+
+    return slack;
 }
 
-void DAG::propagateBeRequired(const Cell &current_cell, int current_id, int fanin_id, const ASIC &asic, const std::map<int, Cell> &cell_map)
+void DAG::initializeRequiredTime(const ASIC &asic)
 {
+    for (int endpoint : endpoints())
+    {
+        int index = indexOf(endpoint);
+        required_time[index] = CLOCK_PERIOD - SETUP_TIME; // Set the required time for outputs and register inputs
 
-    float required_time_for_current = required_time[current_id];
+        LOG_TRACE("Endpoint " << netName(asic, endpoint) << " (ID: " << endpoint << ") → Required time = "
+                              << required_time[index]);
+    }
+}
 
-    float required_time_for_fanin = required_time_for_current - current_cell.delay;
-#pragma omp critical
+std::vector<int> DAG::endpoints() const
+{
+    std::vector<int> bits;
+    for (int index = 0; index < numNodes(); ++index)
     {
-        if (required_time.find(fanin_id) == required_time.end())
+        if (isEndpoint(index))
         {
-            required_time[fanin_id] = required_time_for_fanin;
+            bits.push_back(nodeIds[index]);
         }
-        else
+    }
+    return bits;
+}
+
+void DAG::updateArrivalTime(int current, int neighbor, int edge, const CellStore &cells)
+{
+    double rc_delay = edge_rc[edge];
+    double slew = edge_slew[edge];
+
+    double neighbor_cell_delay = cells.delay[cells.find(nodeIds[neighbor])];
+
+    double total_delay = (rc_delay + slew) * 10e9 + neighbor_cell_delay;
+    std::atomic<float> &neighbor_arrival = arrival_time[neighbor];
+    double new_arrival = arrival_time[current].load(std::memory_order_relaxed) + total_delay;
+    atomicMax(neighbor_arrival, new_arrival);
+
+    // The early (hold) arrival rides along on the same edge visit
+    double new_early = earlyArrival(current) + total_delay;
+    atomicMin(early_arrival_time[neighbor], new_early);
+
+    LOG_TRACE("The delay for rc and slew is " << (rc_delay + slew) * 10e9);
+    LOG_TRACE("Updating arrival time for cell " << nodeIds[neighbor]
+                                                << ": max(..., " << new_arrival
+                                                << ") = " << neighbor_arrival.load());
+
+    return;
+}
+
+void DAG::propagateForward(int node, const CellStore &cells)
+{
+    int cell = cells.find(nodeIds[node]);
+    if (cell < 0)
+    {
+        return;
+    }
+
+    // The node's own values are final once its task runs, so they are read once for all edges
+    const double resistance = cells.resistance[cell];
+    const float arrival = arrival_time[node].load(std::memory_order_relaxed);
+    const float early = earlyArrival(node);
+    const double voltage_swing = 1.0;
+
+    for (int e = fanoutOffsets[node]; e < fanoutOffsets[node + 1]; ++e)
+    {
+        int neighbor = fanoutTargets[e];
+        int neighbor_cell = cells.find(nodeIds[neighbor]);
+        if (neighbor_cell < 0)
         {
-            required_time[fanin_id] = std::min(required_time[fanin_id], required_time_for_fanin);
+            continue;
         }
+
+        // Same arithmetic as computeRCDelay, computeSlewRate and updateArrivalTime
+        double rc_delay = resistance * cells.capacitance[neighbor_cell];
+        double slew = voltage_swing / (voltage_swing / rc_delay);
+        edge_rc[e] = rc_delay;
+        edge_slew[e] = slew;
+
+        double total_delay = (rc_delay + slew) * 10e9 + cells.delay[neighbor_cell];
+        atomicMax(arrival_time[neighbor], arrival + total_delay);
+        atomicMin(early_arrival_time[neighbor], early + total_delay);
+
+        LOG_TRACE("Edge " << nodeIds[node] << " -> " << nodeIds[neighbor] << " | RC: " << rc_delay
+                          << " | Slew: " << slew << " | Arrival: " << arrival_time[neighbor].load());
+    }
+}
+
+double DAG::computeSlewRate(const CellStore &cells, int current_cell, int neighbor_cell, int edge)
+{
+
+    double voltage_swing = 1.0; // V
+    double rc_delay = edge_rc[edge];
+
+    double rc_time_constant = rc_delay;
+    double slew_rate = voltage_swing / rc_time_constant;
+    double slew_time = voltage_swing / slew_rate; // (V / (V/s)) = seconds
+    edge_slew[edge] = slew_time;
+
+    LOG_TRACE("Computing Slew Rate: "
+              << "Resistance of current cell = " << cells.resistance[current_cell]
+              << ", Capacitance of neighbor cell = " << cells.capacitance[neighbor_cell]
+              << " => Slew Rate = " << slew_time << " V/s");
+    return slew_time;
+}
+
+// Function to compute RC delay between two cells
+double DAG::computeRCDelay(const CellStore &cells, int current_cell, int neighbor_cell, int edge)
+{
+
+    double rc_delay = cells.resistance[current_cell] * cells.capacitance[neighbor_cell];
+    edge_rc[edge] = rc_delay;
+
+    LOG_TRACE("Computing RC Delay: "
+              << "Resistance of current cell = " << cells.id[current_cell]
+              << ", Capacitance of neighbor cell = " << cells.capacitance[neighbor_cell]
+              << " => RC Delay = " << rc_delay);
+    return rc_delay;
+}
+
+// Builds the fanin CSR from the fanout CSR
+void DAG::reverseList()
+{
+    const int n = numNodes();
+    faninOffsets.assign(n + 1, 0);
+    for (int target : fanoutTargets)
+    {
+        faninOffsets[target + 1]++;
+    }
+    for (int v = 0; v < n; ++v)
+    {
+        faninOffsets[v + 1] += faninOffsets[v];
     }
 
-    if (verbose)
+    faninSources.resize(fanoutTargets.size());
+    faninEdges.resize(fanoutTargets.size());
+    std::vector<int> cursor(faninOffsets.begin(), faninOffsets.end() - 1);
+    for (int u = 0; u < n; ++u)
     {
-        std::string fanin_name = asic.net_dict.count(fanin_id) ? asic.net_dict.at(fanin_id) : "Unknown";
-        std::cout << "Fan-in " << fanin_name << " (ID: " << fanin_id
-                  << ") → Required time updated to " << required_time[fanin_id]
-                  << " (via " << current_cell.delay << " delay)\n";
+        for (int e = fanoutOffsets[u]; e < fanoutOffsets[u + 1]; ++e)
+        {
+            int slot = cursor[fanoutTargets[e]]++;
+            faninSources[slot] = u;
+            faninEdges[slot] = e;
+        }
     }
 }
 
-std::unordered_map<int, float> DAG::computeSlack(const ASIC &asic, const std::vector<int> &sorted)
+std::unordered_map<int, float> DAG::analyzeTiming(const ASIC &asic, const CellStore &cells, std::vector<int> &sorted)
 {
+    std::unordered_map<int, int> required_time;
     std::unordered_map<int, float> slack;
 
-    if (verbose)
+    // reverseList();
+
+    LOG_TRACE("\n=== Step 1: Initializing required times at outputs ===");
+
+    for (int output : asic.outputs)
     {
-        std::cout << "\n=== Step 3: Slack Computation ===\n";
+        required_time[output] = CLOCK_PERIOD - SETUP_TIME;
+        LOG_TRACE("Output net " << netName(asic, output) << " (ID: " << output << ") → Required time = "
+                                << required_time[output]);
     }
 
+    LOG_TRACE("\n=== Step 2: Propagating required times (backward) ===");
+    for (auto it = sorted.rbegin(); it != sorted.rend(); ++it)
+    {
+        int current = *it;
+
+        if (required_time.find(current) == required_time.end())
+        {
+            required_time[current] = INT64_MAX;
+        }
+
+        int index = indexOf(current);
+        if (index >= 0)
+        {
+            for (int i = faninOffsets[index]; i < faninOffsets[index + 1]; ++i)
+            {
+                int fanin = nodeIds[faninSources[i]];
+                float cell_delay = 0.0f;
+
+                if (cells.find(current) >= 0)
+                {
+                    cell_delay = cells.delay[cells.find(current)];
+                }
+
+                int candidate_time = required_time[current] - cell_delay;
+
+                if (required_time.find(fanin) == required_time.end())
+                {
+                    required_time[fanin] = candidate_time;
+                }
+                else
+                {
+                    required_time[fanin] = std::min(required_time[fanin], candidate_time);
+                }
+
+                LOG_TRACE("  Fanin " << netName(asic, fanin) << " (ID: " << fanin
+                                     << ") → Required time updated to " << required_time[fanin]
+                                     << " (via " << cell_delay << " delay)");
+            }
+        }
+    }
+
+    LOG_TRACE("\n=== Step 3: Slack Computation ===");
+
     for (int net : sorted)
     {
-        float at = arrival_time.count(net) ? arrival_time.at(net) : 0.0f;
+        float at = arrival_time[indexOf(net)].load(std::memory_order_relaxed);
         float rt = required_time.count(net) ? required_time[net] : CLOCK_PERIOD;
 
         float s = rt - at;
-
         slack[net] = s;
 
-        if (verbose)
+        LOG_TRACE("Net " << netName(asic, net) << " (ID: " << net << ")"
+                         << " | Arrival: " << at
+                         << " | Required: " << rt
+                         << " | Slack: " << s
+                         << (s < 0 ? " VIOLATION!" : s == 0 ? " CRITICAL PATH" : ""));
+    }
+    return slack;
+}
+// Kahn's algorithm over a CSR graph; nodes on a cycle are left out of the order
+static std::vector<int> topologicalOrder(const std::vector<int> &offsets, const std::vector<int> &targets)
+{
+    const int n = static_cast<int>(offsets.size()) - 1;
+    std::vector<int> inDegree(n, 0);
+    for (int target : targets)
+    {
+        inDegree[target]++;
+    }
+
+    std::vector<int> order;
+    order.reserve(n);
+    for (int node = 0; node < n; ++node)
+    {
+        if (inDegree[node] == 0)
         {
-            std::string net_name = asic.net_dict.count(net) ? asic.net_dict.at(net) : "Unknown";
+            order.push_back(node);
+        }
+    }
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        int node = order[i];
+        for (int e = offsets[node]; e < offsets[node + 1]; ++e)
+        {
+            if (--inDegree[targets[e]] == 0)
+            {
+                order.push_back(targets[e]);
+            }
+        }
+    }
+    return order;
+}
+
+// Positions every node in a topological order of the current fanout CSR
+void DAG::computeTopoRank()
+{
+    std::vector<int> order = topologicalOrder(fanoutOffsets, fanoutTargets);
+    topoRank.assign(numNodes(), 0);
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        topoRank[order[i]] = static_cast<int>(i);
+    }
+}
+
+// Rebuilds the fanout CSR with the staged edge removals and additions. Surviving edges keep
+// their rc/slew values; the fanin CSR, task graph and topological ranks are rebuilt to match.
+void DAG::applyEdgeEdits(const ASIC &asic)
+{
+    const int n = numNodes();
+    const int old_n = std::max(0, static_cast<int>(fanoutOffsets.size()) - 1);
 
-            std::cout << "Net " << net_name << " (ID: " << net << ")"
-                      << " | Arrival: " << at
-                      << " | Required: " << rt
-                      << " | Slack: " << s;
+    std::sort(removedEdges.begin(), removedEdges.end());
+    auto is_removed = [&](int from, int to)
+    {
+        return !removedEdges.empty() &&
+               std::binary_search(removedEdges.begin(), removedEdges.end(), std::make_pair(from, to));
+    };
 
-            if (s < 0)
+    std::vector<int> offsets(n + 1, 0);
+    for (int u = 0; u < old_n; ++u)
+    {
+        for (int e = fanoutOffsets[u]; e < fanoutOffsets[u + 1]; ++e)
+        {
+            if (!is_removed(u, fanoutTargets[e]))
             {
-                std::cout << " VIOLATION!";
+                offsets[u + 1]++;
             }
-            else if (s == 0)
+        }
+    }
+    for (const auto &[from, to] : edgeList)
+    {
+        offsets[from + 1]++;
+    }
+    for (int u = 0; u < n; ++u)
+    {
+        offsets[u + 1] += offsets[u];
+    }
+
+    std::vector<int> targets(offsets[n]);
+    FirstTouchVector<double> rc(offsets[n], 0.0);
+    FirstTouchVector<double> slew(offsets[n], 0.0);
+    std::vector<int> cursor(offsets.begin(), offsets.end() - 1);
+    for (int u = 0; u < old_n; ++u)
+    {
+        for (int e = fanoutOffsets[u]; e < fanoutOffsets[u + 1]; ++e)
+        {
+            if (!is_removed(u, fanoutTargets[e]))
             {
-                std::cout << " CRITICAL PATH";
+                int pos = cursor[u]++;
+                targets[pos] = fanoutTargets[e];
+                rc[pos] = edge_rc[e];
+                slew[pos] = edge_slew[e];
             }
+        }
+    }
+    for (const auto &[from, to] : edgeList)
+    {
+        targets[cursor[from]++] = to;
+    }
+
+    fanoutOffsets = std::move(offsets);
+    fanoutTargets = std::move(targets);
+    edge_rc = std::move(rc);
+    edge_slew = std::move(slew);
+    edgeList.clear();
+    removedEdges.clear();
 
-            std::cout << std::endl;
+    // Nodes created by ecoAddEdge start out like in a full run: arrival 0, no required time
+    const int old_nodes = static_cast<int>(arrival_time.size());
+    for (int node = old_nodes; node < n; ++node)
+    {
+        dirtyArrival.push_back(node);
+        dirtyRequired.push_back(node);
+    }
+    if (old_nodes < n)
+    {
+        const float inf = std::numeric_limits<float>::infinity();
+        FirstTouchVector<std::atomic<float>> arrival(n);
+        FirstTouchVector<std::atomic<float>> early(n);
+        FirstTouchVector<std::atomic<float>> required(n);
+        for (int i = 0; i < n; ++i)
+        {
+            bool old = i < static_cast<int>(arrival_time.size());
+            arrival[i].store(old ? arrival_time[i].load() : 0.0f, std::memory_order_relaxed);
+            early[i].store(old ? early_arrival_time[i].load() : inf, std::memory_order_relaxed);
+            required[i].store(old ? required_time[i].load() : inf, std::memory_order_relaxed);
         }
+        arrival_time.swap(arrival);
+        early_arrival_time.swap(early);
+        required_time.swap(required);
     }
 
-    return slack;
+    // A new edge that closes a loop is cut like any other; the back edge dropped may be
+    // an old one, so every node is re-evaluated
+    int edges = numEdges();
+    removeCycles();
+    if (numEdges() != edges)
+    {
+        for (int node = 0; node < n; ++node)
+        {
+            dirtyArrival.push_back(node);
+            dirtyRequired.push_back(node);
+        }
+    }
+
+    reverseList();
+    buildTaskGraph(asic);
+    computeTopoRank();
+    partitionRegions();
+    levelOffsets.clear();
+    levelNodes.clear();
+    backLevelOffsets.clear();
+    backLevelNodes.clear();
+    clusterOffsets.clear();
+    clusterNodes.clear();
 }
 
-void DAG::initializeRequiredTime(const ASIC &asic, const std::map<int, Cell> &cell_map)
+// Late and early arrival of a node from its fanins, as the rc, slew and arrival stages compute them
+float DAG::evalArrival(int node, const CellStore &cells, float &early)
 {
-    for (int output : asic.outputs)
+    if (is_launch[node])
     {
-        required_time[output] = CLOCK_PERIOD - SETUP_TIME; // Set the required time for outputs
+        early = CLK2Q_MIN;
+        return CLK2Q_MAX;
+    }
+
+    float arrival = 0.0f;
+    early = std::numeric_limits<float>::infinity();
+    int cell = cells.find(nodeIds[node]);
+    if (cell < 0)
+    {
+        return arrival;
+    }
 
-        std::string output_name = asic.net_dict.count(output) ? asic.net_dict.at(output) : "Unknown";
-        if (verbose)
+    for (int i = faninOffsets[node]; i < faninOffsets[node + 1]; ++i)
+    {
+        int fanin = faninSources[i];
+        int e = faninEdges[i];
+        int fanin_cell = cells.find(nodeIds[fanin]);
+        if (fanin_cell < 0)
         {
-            std::cout << "Output " << output_name << " (ID: " << output << ") → Required time = "
-                      << required_time[output] << "\n";
+            continue;
         }
+
+        computeRCDelay(cells, fanin_cell, cell, e);
+        computeSlewRate(cells, fanin_cell, cell, e);
+        double total_delay = (edge_rc[e] + edge_slew[e]) * 10e9 + cells.delay[cell];
+        float candidate = arrival_time[fanin].load(std::memory_order_relaxed) + total_delay;
+        float early_candidate = earlyArrival(fanin) + total_delay;
+        arrival = std::max(arrival, candidate);
+        early = std::min(early, early_candidate);
     }
+    return arrival;
 }
 
-void DAG::updateArrivalTime(int current, int neighbor, const std::map<int, Cell> &cell_map)
+// Required time of a node from its fanouts, as the be_required stage computes it
+float DAG::evalRequired(int node, const CellStore &cells) const
 {
-    double rc_delay = 0;
-    double slew = 0;
-    for (const auto &[from, to, rc_delay_value] : rc_value)
+    float required = isEndpoint(node) ? CLOCK_PERIOD - SETUP_TIME : std::numeric_limits<float>::infinity();
+
+    for (int e = fanoutOffsets[node]; e < fanoutOffsets[node + 1]; ++e)
     {
-        if (from == current && to == neighbor)
+        int fanout = fanoutTargets[e];
+        int fanout_cell = cells.find(nodeIds[fanout]);
+        float fanout_required = required_time[fanout].load(std::memory_order_relaxed);
+        if (fanout_cell < 0 || std::isinf(fanout_required))
         {
-            rc_delay = rc_delay_value;
+            continue;
         }
+        float candidate = fanout_required - cells.delay[fanout_cell];
+        required = std::min(required, candidate);
     }
-    for (const auto &[from, to, slew_value_in] : slew_value)
+    return required;
+}
+
+// A cell's delay feeds its own arrival and its fanins' required times, its R the rc of
+// its fanout edges and its C the rc of its fanin edges
+void DAG::markCellChanged(int bit)
+{
+    int node = indexOf(bit);
+    if (node < 0)
     {
-        if (from == current && to == neighbor)
+        return;
+    }
+
+    dirtyArrival.push_back(node);
+    if (node + 1 < static_cast<int>(fanoutOffsets.size()))
+    {
+        for (int e = fanoutOffsets[node]; e < fanoutOffsets[node + 1]; ++e)
+        {
+            dirtyArrival.push_back(fanoutTargets[e]);
+        }
+    }
+    if (node + 1 < static_cast<int>(faninOffsets.size()))
+    {
+        for (int i = faninOffsets[node]; i < faninOffsets[node + 1]; ++i)
         {
-            slew = slew_value_in;
+            dirtyRequired.push_back(faninSources[i]);
         }
     }
+}
 
-    double current_cell_delay = cell_map.at(current).delay;
-    double neighbor_cell_delay = cell_map.at(neighbor).delay;
+bool DAG::ecoSetCellType(CellStore &cells, int bit, CellType type)
+{
+    int cell = cells.find(bit);
+    if (cell < 0)
+    {
+        return false;
+    }
+    if (is_sequential(type) != is_sequential(cells.type[cell]))
+    {
+        return false;
+    }
+    cells.type[cell] = type;
+    cells.delay[cell] = get_delay(type);
+    std::tie(cells.resistance[cell], cells.capacitance[cell]) = get_rc(type);
+    markCellChanged(bit);
+    return true;
+}
 
-    double total_delay = (rc_delay + slew) * 10e9 + neighbor_cell_delay;
-    double old_arrival = 0.0;
-    double new_arrival = 0.0;
-#pragma omp critical
+bool DAG::ecoSetCellDelay(CellStore &cells, int bit, double delay)
+{
+    int cell = cells.find(bit);
+    if (cell < 0)
+    {
+        return false;
+    }
+    cells.delay[cell] = delay;
+    markCellChanged(bit);
+    return true;
+}
+
+bool DAG::ecoResizeCell(CellStore &cells, int bit, double resistance, double capacitance)
+{
+    int cell = cells.find(bit);
+    if (cell < 0)
+    {
+        return false;
+    }
+    cells.resistance[cell] = resistance;
+    cells.capacitance[cell] = capacitance;
+    markCellChanged(bit);
+    return true;
+}
+
+bool DAG::ecoAddEdge(int from, int to)
+{
+    // A register output is driven by its register alone and always launches at clock-to-Q
+    int target = indexOf(to);
+    if (target >= 0 && target < static_cast<int>(is_launch.size()) && is_launch[target])
+    {
+        return false;
+    }
+    addEdge(from, to);
+    dirtyArrival.push_back(indexOf(to));
+    dirtyRequired.push_back(indexOf(from));
+    return true;
+}
+
+void DAG::ecoRemoveEdge(int from, int to)
+{
+    int u = indexOf(from);
+    int v = indexOf(to);
+    if (u < 0 || v < 0)
+    {
+        return;
+    }
+
+    edgeList.erase(std::remove(edgeList.begin(), edgeList.end(), std::make_pair(u, v)), edgeList.end());
+    removedEdges.emplace_back(u, v);
+    dirtyArrival.push_back(v);
+    dirtyRequired.push_back(u);
+}
+
+// Re-propagates timing from the nodes marked by the eco* edits. Requires a completed full
+// run (createTaskGraph, initializeRequiredTime, topological_TaskGraph) on this DAG.
+int DAG::updateTiming(const ASIC &asic, const CellStore &cells)
+{
+    if (!edgeList.empty() || !removedEdges.empty())
     {
-        if (arrival_time.find(neighbor) == arrival_time.end())
+        applyEdgeEdits(asic);
+    }
+    if (static_cast<int>(topoRank.size()) != numNodes())
+    {
+        computeTopoRank();
+    }
+    queued.resize(numNodes(), 0);
+
+    int changed = 0;
+    using Entry = std::pair<int, int>; // topological rank, node
+
+    // Forward: lowest rank first, so a node's fanins are final before it is evaluated
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> forward;
+    for (int node : dirtyArrival)
+    {
+        if (!queued[node])
         {
-            arrival_time[neighbor] = 0;
+            queued[node] = 1;
+            forward.emplace(topoRank[node], node);
         }
+    }
+    dirtyArrival.clear();
 
-        old_arrival = arrival_time[neighbor];
-        new_arrival = arrival_time[current] + total_delay;
-        arrival_time[neighbor] = std::max(old_arrival, new_arrival);
-        if (verbose)
+    while (!forward.empty())
+    {
+        int node = forward.top().second;
+        forward.pop();
+        queued[node] = 0;
+
+        float early;
+        float arrival = evalArrival(node, cells, early);
+        if (arrival == arrival_time[node].load(std::memory_order_relaxed) &&
+            early == early_arrival_time[node].load(std::memory_order_relaxed))
         {
-            std::cout << "The delay for rc and slew is " << (rc_delay + slew) * 10e9 << std::endl;
-            std::cout << "Updating arrival time for cell " << neighbor
-                      << ": max(" << old_arrival << ", "
-                      << new_arrival
-                      << ") = " << arrival_time[neighbor] << std::endl;
+            continue;
+        }
+        arrival_time[node].store(arrival, std::memory_order_relaxed);
+        early_arrival_time[node].store(early, std::memory_order_relaxed);
+        ++changed;
+
+        for (int e = fanoutOffsets[node]; e < fanoutOffsets[node + 1]; ++e)
+        {
+            int fanout = fanoutTargets[e];
+            if (!queued[fanout])
+            {
+                queued[fanout] = 1;
+                forward.emplace(topoRank[fanout], fanout);
+            }
         }
     }
 
-    return;
+    // Backward: highest rank first, so a node's fanouts are final before it is evaluated
+    std::priority_queue<Entry> backward;
+    for (int node : dirtyRequired)
+    {
+        if (!queued[node])
+        {
+            queued[node] = 1;
+            backward.emplace(topoRank[node], node);
+        }
+    }
+    dirtyRequired.clear();
+
+    while (!backward.empty())
+    {
+        int node = backward.top().second;
+        backward.pop();
+        queued[node] = 0;
+
+        float required = evalRequired(node, cells);
+        if (required == required_time[node].load(std::memory_order_relaxed))
+        {
+            continue;
+        }
+        required_time[node].store(required, std::memory_order_relaxed);
+        ++changed;
+
+        for (int i = faninOffsets[node]; i < faninOffsets[node + 1]; ++i)
+        {
+            int fanin = faninSources[i];
+            if (!queued[fanin])
+            {
+                queued[fanin] = 1;
+                backward.emplace(topoRank[fanin], fanin);
+            }
+        }
+    }
+
+    LOG_DEBUG("Incremental timing update: " << changed << " values changed");
+    return changed;
+}
+
+// Slack of a net from the current timing arrays, with the same fallback as computeSlack
+float DAG::slackOf(int bit) const
+{
+    int index = indexOf(bit);
+    if (index < 0)
+    {
+        return std::numeric_limits<float>::quiet_NaN();
+    }
+    float rt = required_time[index].load(std::memory_order_relaxed);
+    if (std::isinf(rt))
+    {
+        rt = CLOCK_PERIOD;
+    }
+    return rt - arrival_time[index].load(std::memory_order_relaxed);
 }
 
-double DAG::computeSlewRate(const Cell &current_cell, const Cell &neighbor_cell, int current_cell_id, int neighboor_cell_id)
+void DAG::analyzeCorners(const CellStore &cells, const std::vector<Corner> &corner_list)
 {
+    const int n = numNodes();
+    const float inf = std::numeric_limits<float>::infinity();
+    corners = corner_list;
+    if (corners.empty())
+    {
+        corner_arrival.clear();
+        corner_required.clear();
+        return;
+    }
 
-    double rc_delay = 0.0;
-    double voltage_swing = 1.0; // V
-    for (const auto &[from, to, rc_delay_value] : rc_value)
+    // Per-lane derating; spare lanes repeat the last corner
+    alignas(32) double r_scale[CORNER_LANES];
+    alignas(32) double c_scale[CORNER_LANES];
+    alignas(32) double d_scale[CORNER_LANES];
+    alignas(32) float output_required[CORNER_LANES];
+    for (int l = 0; l < CORNER_LANES; ++l)
     {
-        if (from == current_cell_id && to == neighboor_cell_id)
+        const Corner &corner = corners[std::min<int>(l, corners.size() - 1)];
+        r_scale[l] = corner.resistance_scale;
+        c_scale[l] = corner.capacitance_scale;
+        d_scale[l] = corner.delay_scale;
+        output_required[l] = corner.clock_period - corner.setup_time;
+    }
+
+    // Cell parameters gathered per node once, so the sweeps read them in node order
+    std::vector<char> has_cell(n, 0);
+    std::vector<double> resistance(n, 0.0);
+    std::vector<double> capacitance(n, 0.0);
+    std::vector<double> delay(n, 0.0);
+    for (int node = 0; node < n; ++node)
+    {
+        int cell = cells.find(nodeIds[node]);
+        if (cell >= 0)
         {
-            rc_delay = rc_delay_value;
+            has_cell[node] = 1;
+            resistance[node] = cells.resistance[cell];
+            capacitance[node] = cells.capacitance[cell];
+            delay[node] = cells.delay[cell];
         }
     }
 
-    double rc_time_constant = rc_delay;
-    double slew_rate = voltage_swing / rc_time_constant;
-    double slew_time = voltage_swing / slew_rate; // (V / (V/s)) = seconds
-#pragma omp critical
+    corner_arrival.assign(n, CornerTimes{});
+    corner_required.assign(n, CornerTimes{});
+
+    // A node runs once all of its fanins (forward) or fanouts (backward) are done, and only
+    // writes its own lanes, so the sweeps need no atomics
+    std::vector<int> fanin_count(n);
+    std::vector<int> fanout_count(n);
+    for (int node = 0; node < n; ++node)
     {
-        slew_value.push_back({current_cell_id, neighboor_cell_id, slew_time});
+        fanin_count[node] = faninOffsets[node + 1] - faninOffsets[node];
+        fanout_count[node] = fanoutOffsets[node + 1] - fanoutOffsets[node];
     }
 
-    if (verbose)
+    // Same arithmetic as computeRCDelay, computeSlewRate and updateArrivalTime, per lane
+    auto arrive = [&](int node, int)
     {
-        std::cout << "Computing Slew Rate: "
-                  << "Resistance of current cell = " << current_cell.resistance
-                  << ", Capacitance of neighbor cell = " << neighbor_cell.capacitance
-                  << " => Slew Rate = " << slew_time << " V/s" << std::endl;
+        float *out = corner_arrival[node].lane;
+        if (is_launch[node])
+        {
+            for (int l = 0; l < CORNER_LANES; ++l)
+            {
+                out[l] = CLK2Q_MAX;
+            }
+            return;
+        }
+        if (!has_cell[node])
+        {
+            return;
+        }
+        for (int i = faninOffsets[node]; i < faninOffsets[node + 1]; ++i)
+        {
+            int fanin = faninSources[i];
+            if (!has_cell[fanin])
+            {
+                continue;
+            }
+            const float *in = corner_arrival[fanin].lane;
+            const double r = resistance[fanin];
+            const double c = capacitance[node];
+            const double d = delay[node];
+#pragma omp simd
+            for (int l = 0; l < CORNER_LANES; ++l)
+            {
+                double rc = (r * r_scale[l]) * (c * c_scale[l]);
+                double slew = 1.0 / (1.0 / rc);
+                float candidate = in[l] + ((rc + slew) * 10e9 + d * d_scale[l]);
+                out[l] = candidate > out[l] ? candidate : out[l];
+            }
+        }
+    };
+
+    // Same arithmetic as propagateBeRequired, per lane
+    auto require = [&](int node, int)
+    {
+        float *out = corner_required[node].lane;
+        for (int l = 0; l < CORNER_LANES; ++l)
+        {
+            out[l] = isEndpoint(node) ? output_required[l] : inf;
+        }
+        for (int e = fanoutOffsets[node]; e < fanoutOffsets[node + 1]; ++e)
+        {
+            int fanout = fanoutTargets[e];
+            if (!has_cell[fanout])
+            {
+                continue;
+            }
+            const float *in = corner_required[fanout].lane;
+            const double d = delay[fanout];
+#pragma omp simd
+            for (int l = 0; l < CORNER_LANES; ++l)
+            {
+                float candidate = in[l] - d * d_scale[l];
+                out[l] = candidate < out[l] ? candidate : out[l];
+            }
+        }
+    };
+
+    auto owner = [&](int node) { return nodeRegion[node]; };
+    int forward = executor.run(fanoutOffsets, fanoutTargets, fanin_count, arrive, owner);
+    int backward = executor.run(faninOffsets, faninSources, fanout_count, require, owner);
+    if (forward < n || backward < n)
+    {
+        LOG_ERROR("\nError: Multi-corner sweep stopped early. Possible cycle in the graph.");
     }
-    return slew_time;
 }
 
-// Function to compute RC delay between two cells
-double DAG::computeRCDelay(const Cell &current_cell, const Cell &neighbor_cell, int current_id, int neighbor_id)
+// Slack of a net in one corner, with the same fallback as computeSlack
+float DAG::cornerSlack(int bit, int corner) const
 {
-
-    double rc_delay = current_cell.resistance * neighbor_cell.capacitance;
-#pragma omp critical
+    int index = indexOf(bit);
+    if (index < 0 || index >= static_cast<int>(corner_required.size()) || corner < 0 ||
+        corner >= static_cast<int>(corners.size()))
     {
-        rc_value.push_back({current_id, neighbor_id, rc_delay});
+        return std::numeric_limits<float>::quiet_NaN();
     }
+    float rt = corner_required[index].lane[corner];
+    if (std::isinf(rt))
+    {
+        rt = corners[corner].clock_period;
+    }
+    return rt - corner_arrival[index].lane[corner];
+}
 
-    if (verbose)
+// Hold check at every endpoint: the earliest data change (register paths launch CLK2Q_MIN
+// after the clock) must come after the hold window, widened by the worst clock skew
+std::unordered_map<int, float> DAG::computeHoldSlack(const ASIC &asic)
+{
+    std::unordered_map<int, float> slack;
+    for (int endpoint : endpoints())
     {
-        std::cout << "Computing RC Delay: "
-                  << "Resistance of current cell = " << current_cell.id
-                  << ", Capacitance of neighbor cell = " << neighbor_cell.capacitance
-                  << " => RC Delay = " << rc_delay << std::endl;
+        int index = indexOf(endpoint);
+        float at = earlyArrival(index);
+        float rt = HOLD_TIME + CLK_SKEW_MAX;
+        slack[endpoint] = at - rt;
+
+        LOG_TRACE("Endpoint " << netName(asic, endpoint) << " (ID: " << endpoint << ")"
+                            << " | Early arrival: " << at
+                            << " | Hold requirement: " << rt
+                            << " | Hold slack: " << at - rt);
     }
-    return rc_delay;
+    return slack;
 }
 
-void DAG::reverseList()
+// Frontier-based levelization over one direction of the graph. A node joins the next frontier
+// when the last of its predecessors is placed; frontiers are written straight into nodes.
+static void buildLevels(const std::vector<int> &offsets, const std::vector<int> &targets,
+                        const std::vector<int> &pred_offsets, std::vector<int> &level_offsets,
+                        std::vector<int> &nodes)
 {
-    for (const auto &[u, neighbors] : adjList)
+    const int n = static_cast<int>(offsets.size()) - 1;
+    std::unique_ptr<std::atomic<int>[]> pending(new std::atomic<int>[n]);
+    std::atomic<int> tail{0};
+    nodes.resize(n);
+
+#pragma omp parallel for schedule(static)
+    for (int node = 0; node < n; ++node)
     {
-        for (int v : neighbors)
+        int count = pred_offsets[node + 1] - pred_offsets[node];
+        pending[node].store(count, std::memory_order_relaxed);
+        if (count == 0)
         {
-            reverseAdjList[v].push_back(u);
+            nodes[tail.fetch_add(1, std::memory_order_relaxed)] = node;
         }
     }
+
+    level_offsets.assign(1, 0);
+    int begin = 0;
+    while (begin < tail.load())
+    {
+        int end = tail.load();
+        // Ascending node order inside a level keeps sweeps deterministic and cache friendly
+        std::sort(nodes.begin() + begin, nodes.begin() + end);
+        level_offsets.push_back(end);
+
+#pragma omp parallel for schedule(static)
+        for (int i = begin; i < end; ++i)
+        {
+            int node = nodes[i];
+            for (int e = offsets[node]; e < offsets[node + 1]; ++e)
+            {
+                int next = targets[e];
+                if (pending[next].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    nodes[tail.fetch_add(1, std::memory_order_relaxed)] = next;
+                }
+            }
+        }
+        begin = end;
+    }
+
+    if (begin < n)
+    {
+        LOG_ERROR("\nError: Only " << begin << " of " << n << " nodes levelized. Possible cycle in graph.");
+        nodes.resize(begin);
+    }
 }
 
-std::unordered_map<int, float> DAG::analyzeTiming(const ASIC &asic, const std::map<int, Cell> &cell_map, std::vector<int> &sorted)
+void DAG::levelize()
 {
-    std::unordered_map<int, int> required_time;
-    std::unordered_map<int, float> slack;
-
-    // reverseList();
+    buildLevels(fanoutOffsets, fanoutTargets, faninOffsets, levelOffsets, levelNodes);
+    buildLevels(faninOffsets, faninSources, fanoutOffsets, backLevelOffsets, backLevelNodes);
+    LOG_DEBUG("Levelized " << numNodes() << " nodes into " << numLevels() << " levels");
+}
 
-    if (verbose)
+void DAG::annotateDelays(CellStore &cells, const NldmLibrary &library)
+{
+    // Library pin capacitance and drive resistance replace the built-in R/C values first, so
+    // loads and the wire model both see them
+    for (int c = 0; c < cells.size(); ++c)
     {
-        std::cout << "\n=== Step 1: Initializing required times at outputs ===\n";
+        const NldmCell *spec = library.find(cells.type[c]);
+        if (spec && spec->capacitance >= 0)
+        {
+            cells.capacitance[c] = spec->capacitance;
+        }
+        if (spec && spec->resistance >= 0)
+        {
+            cells.resistance[c] = spec->resistance;
+        }
     }
 
-    for (int output : asic.outputs)
+    if (static_cast<int>(levelNodes.size()) != numNodes())
     {
-        required_time[output] = CLOCK_PERIOD - SETUP_TIME;
-        std::string name = asic.net_dict.count(output) ? asic.net_dict.at(output) : "Unknown";
+        levelize();
+    }
 
-        if (verbose)
+    const int n = numNodes();
+    std::vector<double> output_slew(n, library.default_input_slew);
+    std::vector<NldmCache> caches(omp_get_max_threads());
+    int annotated = 0;
+
+    for (int l = 0; l < numLevels(); ++l)
+    {
+#pragma omp parallel for schedule(static) reduction(+ : annotated)
+        for (int i = levelOffsets[l]; i < levelOffsets[l + 1]; ++i)
         {
-            std::cout << "Output net " << name << " (ID: " << output << ") → Required time = "
-                      << required_time[output] << "\n";
+            int node = levelNodes[i];
+            int cell = cells.find(nodeIds[node]);
+            if (cell < 0 || is_sequential(cells.type[cell]))
+            {
+                continue;
+            }
+            const NldmCell *spec = library.find(cells.type[cell]);
+            if (!spec)
+            {
+                continue;
+            }
+
+            // Fanin slews are final: every fanin sits on an earlier level
+            double slew = -1.0;
+            for (int j = faninOffsets[node]; j < faninOffsets[node + 1]; ++j)
+            {
+                if (cells.find(nodeIds[faninSources[j]]) >= 0)
+                {
+                    slew = std::max(slew, output_slew[faninSources[j]]);
+                }
+            }
+            if (slew < 0)
+            {
+                slew = library.default_input_slew;
+            }
+
+            double load = 0.0;
+            for (int e = fanoutOffsets[node]; e < fanoutOffsets[node + 1]; ++e)
+            {
+                int fanout_cell = cells.find(nodeIds[fanoutTargets[e]]);
+                if (fanout_cell >= 0)
+                {
+                    load += cells.capacitance[fanout_cell];
+                }
+            }
+
+            auto [delay, out_slew] = caches[omp_get_thread_num()].lookup(cells.type[cell], *spec, slew, load);
+            cells.delay[cell] = delay;
+            output_slew[node] = out_slew;
+            ++annotated;
         }
     }
 
-    if (verbose)
+    long hits = 0;
+    long misses = 0;
+    for (const NldmCache &cache : caches)
     {
-        std::cout << "\n=== Step 2: Propagating required times (backward) ===\n";
+        hits += cache.hits;
+        misses += cache.misses;
     }
-    for (auto it = sorted.rbegin(); it != sorted.rend(); ++it)
+    LOG_INFO("Annotated " << annotated << " cells from the NLDM library; lookup cache " << hits << " hits, "
+                          << misses << " misses");
+}
+
+// Each node pulls from its fanins (forward) or fanouts (backward) and writes only its own
+// values and fanin edges, so a level runs without atomics or queues
+void DAG::sweepArrivals(const CellStore &cells)
+{
+    if (static_cast<int>(levelNodes.size()) != numNodes())
     {
-        int current = *it;
+        levelize();
+    }
 
-        if (required_time.find(current) == required_time.end())
+    for (int l = 0; l + 1 < static_cast<int>(levelOffsets.size()); ++l)
+    {
+#pragma omp parallel for schedule(static)
+        for (int i = levelOffsets[l]; i < levelOffsets[l + 1]; ++i)
         {
-            required_time[current] = INT64_MAX;
+            int node = levelNodes[i];
+            float early;
+            float arrival = evalArrival(node, cells, early);
+            arrival_time[node].store(arrival, std::memory_order_relaxed);
+            early_arrival_time[node].store(early, std::memory_order_relaxed);
+        }
+    }
+}
+
+void DAG::sweepRequired(const CellStore &cells)
+{
+    if (static_cast<int>(backLevelNodes.size()) != numNodes())
+    {
+        levelize();
+    }
+
+    for (int l = 0; l + 1 < static_cast<int>(backLevelOffsets.size()); ++l)
+    {
+#pragma omp parallel for schedule(static)
+        for (int i = backLevelOffsets[l]; i < backLevelOffsets[l + 1]; ++i)
+        {
+            int node = backLevelNodes[i];
+            required_time[node].store(evalRequired(node, cells), std::memory_order_relaxed);
         }
+    }
+}
+
+std::vector<int> DAG::levelSweep(const CellStore &cells)
+{
+    sweepArrivals(cells);
+    sweepRequired(cells);
+
+    std::vector<int> result;
+    result.reserve(levelNodes.size());
+    for (int node : levelNodes)
+    {
+        result.push_back(nodeIds[node]);
+    }
+    return result;
+}
+
+// Greedy clustering in topological order. Every cluster has a rank larger than the ranks of the
+// clusters it depends on; a node joins the highest-ranked cluster among its fanins only if its
+// other fanins lie in lower-ranked clusters, which keeps the cluster graph acyclic. Sources share
+// rank-0 clusters.
+void DAG::buildClusters(int cluster_size)
+{
+    const int n = numNodes();
+    clusterLimit = std::max(1, cluster_size);
+
+    std::vector<int> order = topologicalOrder(fanoutOffsets, fanoutTargets);
+    std::vector<int> cluster_of(n, -1);
+    std::vector<int> rank;
+    std::vector<int> size;
+    int source_cluster = -1;
 
-        if (reverseAdjList.count(current))
+    for (int node : order)
+    {
+        int best = -1;
+        int max_rank = -1;
+        for (int i = faninOffsets[node]; i < faninOffsets[node + 1]; ++i)
         {
-            for (int fanin : reverseAdjList[current])
+            int c = cluster_of[faninSources[i]];
+            if (best < 0 || rank[c] > rank[best])
             {
-                float cell_delay = 0.0f;
+                best = c;
+            }
+            max_rank = std::max(max_rank, rank[c]);
+        }
 
-                if (cell_map.count(current))
+        int target = -1;
+        if (best < 0)
+        {
+            if (source_cluster >= 0 && size[source_cluster] < clusterLimit)
+            {
+                target = source_cluster;
+            }
+        }
+        else if (size[best] < clusterLimit)
+        {
+            target = best;
+            for (int i = faninOffsets[node]; i < faninOffsets[node + 1]; ++i)
+            {
+                int c = cluster_of[faninSources[i]];
+                if (c != best && rank[c] >= rank[best])
                 {
-                    cell_delay = cell_map.at(current).delay;
+                    target = -1;
+                    break;
                 }
+            }
+        }
 
-                int candidate_time = required_time[current] - cell_delay;
+        if (target < 0)
+        {
+            target = static_cast<int>(rank.size());
+            rank.push_back(max_rank + 1);
+            size.push_back(0);
+            if (best < 0)
+            {
+                source_cluster = target;
+            }
+        }
+        cluster_of[node] = target;
+        size[target]++;
+    }
 
-                if (required_time.find(fanin) == required_time.end())
-                {
-                    required_time[fanin] = candidate_time;
-                }
-                else
+    // Members in topological order, grouped by cluster
+    const int num_clusters = static_cast<int>(rank.size());
+    clusterOffsets.assign(num_clusters + 1, 0);
+    for (int c = 0; c < num_clusters; ++c)
+    {
+        clusterOffsets[c + 1] = clusterOffsets[c] + size[c];
+    }
+    clusterNodes.resize(order.size());
+    std::vector<int> cursor(clusterOffsets.begin(), clusterOffsets.end() - 1);
+    for (int node : order)
+    {
+        clusterNodes[cursor[cluster_of[node]]++] = node;
+    }
+
+    // forward(c) -> forward of the clusters its nodes feed, and -> backward(c) if c holds an endpoint;
+    // backward(c) -> backward of the clusters feeding its nodes
+    std::vector<int> seen(2 * num_clusters, -1);
+    clusterTaskOffsets.assign(1, 0);
+    clusterTaskTargets.clear();
+    auto link = [&](int task, int successor)
+    {
+        if (successor != task && seen[successor] != task)
+        {
+            seen[successor] = task;
+            clusterTaskTargets.push_back(successor);
+        }
+    };
+    for (int c = 0; c < num_clusters; ++c)
+    {
+        int forward = 2 * c;
+        bool has_endpoint = false;
+        for (int i = clusterOffsets[c]; i < clusterOffsets[c + 1]; ++i)
+        {
+            int node = clusterNodes[i];
+            has_endpoint |= isEndpoint(node);
+            for (int e = fanoutOffsets[node]; e < fanoutOffsets[node + 1]; ++e)
+            {
+                int next = cluster_of[fanoutTargets[e]];
+                if (next != c)
                 {
-                    required_time[fanin] = std::min(required_time[fanin], candidate_time);
+                    link(forward, 2 * next);
                 }
+            }
+        }
+        if (has_endpoint)
+        {
+            link(forward, forward + 1);
+        }
+        clusterTaskOffsets.push_back(static_cast<int>(clusterTaskTargets.size()));
 
-                std::string fanin_name = asic.net_dict.count(fanin) ? asic.net_dict.at(fanin) : "Unknown";
-
-                if (verbose)
+        int backward = forward + 1;
+        for (int i = clusterOffsets[c]; i < clusterOffsets[c + 1]; ++i)
+        {
+            int node = clusterNodes[i];
+            for (int j = faninOffsets[node]; j < faninOffsets[node + 1]; ++j)
+            {
+                int prev = cluster_of[faninSources[j]];
+                if (prev != c)
                 {
-                    std::cout << "  Fanin " << fanin_name << " (ID: " << fanin
-                              << ") → Required time updated to " << required_time[fanin]
-                              << " (via " << cell_delay << " delay)\n";
+                    link(backward, 2 * prev + 1);
                 }
             }
         }
+        clusterTaskOffsets.push_back(static_cast<int>(clusterTaskTargets.size()));
     }
 
-    if (verbose)
+    clusterTaskInDegree.assign(2 * num_clusters, 0);
+    for (int target : clusterTaskTargets)
     {
-        std::cout << "\n=== Step 3: Slack Computation ===\n";
+        clusterTaskInDegree[target]++;
     }
 
-    for (int net : sorted)
+    LOG_INFO("Clustered " << n << " nodes into " << num_clusters << " clusters (" << 2 * num_clusters
+                          << " tasks instead of " << numTasks() << ")");
+}
+
+std::vector<int> DAG::clusteredTaskGraph(const CellStore &cells, const ASIC &asic)
+{
+    if (static_cast<int>(clusterNodes.size()) != numNodes())
     {
-        float at = arrival_time.count(net) ? arrival_time.at(net) : 0.0f;
-        float rt = required_time.count(net) ? required_time[net] : CLOCK_PERIOD;
+        buildClusters(clusterLimit);
+    }
 
-        float s = rt - at;
-        slack[net] = s;
+    std::vector<int> result(clusterNodes.size());
+    std::atomic<int> result_size{0};
 
-        std::string net_name = asic.net_dict.count(net) ? asic.net_dict.at(net) : "Unknown";
+    // A cluster runs the fine-grained stages of its nodes back to back: forward in topological
+    // order, required times in reverse, so every value is final before it is propagated
+    auto run = [&](int task, int tid)
+    {
+        int c = task / 2;
+        LOG_TRACE("TID " << tid << " | Processing cluster " << c << (task % 2 ? " backward" : " forward"));
 
-        if (verbose)
+        if (task % 2 == 0)
+        {
+            for (int i = clusterOffsets[c]; i < clusterOffsets[c + 1]; ++i)
+            {
+                int node = clusterNodes[i];
+                if (stagedForward)
+                {
+                    processQueue(taskId(node, STAGE_RC), *this, cells, asic);
+                    processQueue(taskId(node, STAGE_SLEW), *this, cells, asic);
+                }
+                processQueue(taskId(node, STAGE_ARRIVAL), *this, cells, asic);
+            }
+            int pos = result_size.fetch_add(clusterOffsets[c + 1] - clusterOffsets[c], std::memory_order_relaxed);
+            for (int i = clusterOffsets[c]; i < clusterOffsets[c + 1]; ++i)
+            {
+                result[pos++] = nodeIds[clusterNodes[i]];
+            }
+        }
+        else
         {
-            std::cout << "Net " << net_name << " (ID: " << net << ")"
-                      << " | Arrival: " << at
-                      << " | Required: " << rt
-                      << " | Slack: " << s;
-            if (s < 0)
-                std::cout << " VIOLATION!";
-            else if (s == 0)
-                std::cout << " CRITICAL PATH";
-            std::cout << std::endl;
+            for (int i = clusterOffsets[c + 1] - 1; i >= clusterOffsets[c]; --i)
+            {
+                processQueue(taskId(clusterNodes[i], STAGE_BE_REQUIRED), *this, cells, asic);
+            }
         }
+    };
+
+    int executed = executor.run(clusterTaskOffsets, clusterTaskTargets, clusterTaskInDegree, run,
+                                [&](int task) { return nodeRegion[clusterNodes[clusterOffsets[task / 2]]]; });
+
+    if (static_cast<int>(clusterNodes.size()) < numNodes() || executed < 2 * numClusters())
+    {
+        LOG_ERROR("\nError: Only " << result_size.load() << " of " << numNodes()
+                                     << " nodes ran. Possible cycle in task graph.");
+        return {};
     }
-    return slack;
-}
\ No newline at end of file
+    return result;
+}
@@ -8,39 +8,91 @@
 #define CLK_SKEW_MAX 3 // slowest time between clock edge and DFF output changing
 
 #include <vector>
+#include <atomic>
+#include <cmath>
 #include <map>
 #include <queue>
-#include <unordered_set>
+#include <unordered_map>
 #include <omp.h>
 #include "ASIC.hpp"
-#include "verbose.h"
+#include "Corner.hpp"
+#include "Log.hpp"
+#include "NldmLibrary.hpp"
+#include "WorkStealing.hpp"
 
 class DAG
 {
 private:
-    std::map<int, std::vector<int>> adjList;                  // Adjacency list for the graph
-    std::unordered_map<int, std::vector<int>> reverseAdjList; // Reverse adjacency list for the graph
-    // Function to reverse the adjacency list
+    std::vector<std::pair<int, int>> edgeList; // Edges staged by addEdge (node indices) until the CSR is built
+    std::vector<int> bitToIndex;               // Yosys bit -> node index, -1 if the bit is not a node
+    std::vector<char> is_output;               // node index -> 1 if the node is a primary output
+    std::vector<char> is_launch;               // node index -> 1 if a register output drives the node
+    std::vector<char> is_capture;              // node index -> 1 if the node feeds a register data pin
+
+    // Incremental update state
+    std::vector<std::pair<int, int>> removedEdges; // Edges staged by ecoRemoveEdge (node indices)
+    std::vector<int> dirtyArrival;                 // Nodes whose arrival time must be re-evaluated
+    std::vector<int> dirtyRequired;                // Nodes whose required time must be re-evaluated
+    std::vector<int> topoRank;                     // Position of each node in a topological order
+    std::vector<char> queued;
+
+    void buildFanoutCSR();
+    void buildTaskGraph(const ASIC &asic);
+    void applyEdgeEdits(const ASIC &asic);
+    void computeTopoRank();
+    void markCellChanged(int bit);
+    float evalArrival(int node, const CellStore &cells, float &early);
+    float evalRequired(int node, const CellStore &cells) const;
 
 public:
     void reverseList();
 
-    struct rcInfo
-    {
-        int current_cell_id;  // ID of the current cell
-        int neighbor_cell_id; // ID of the neighbor cell
-        double rc_delay;      // RC delay value
-    };
+    // Dense node numbering: Yosys bits are renumbered to 0..N-1 once in buildFromASIC
+    std::vector<int> nodeIds; // node index -> Yosys bit
+    int addNode(int bit);
+    int indexOf(int bit) const { return bit >= 0 && bit < static_cast<int>(bitToIndex.size()) ? bitToIndex[bit] : -1; }
+    int numNodes() const { return static_cast<int>(nodeIds.size()); }
+    int numEdges() const { return static_cast<int>(fanoutTargets.size()); }
+
+    // Forward graph in CSR form: edge e in [fanoutOffsets[u], fanoutOffsets[u + 1]) goes u -> fanoutTargets[e].
+    // The CSR position is the edge id used by the per-edge arrays below.
+    std::vector<int> fanoutOffsets;
+    std::vector<int> fanoutTargets;
+
+    // Reverse graph in CSR form: fanin i of v is faninSources[i], reached through edge faninEdges[i]
+    std::vector<int> faninOffsets;
+    std::vector<int> faninSources;
+    std::vector<int> faninEdges;
+
+    // Sizes the timing arrays; each worker first-touches the values of its own region
+    void initTimingArrays();
 
-    struct slewInfo
+    // Worker pool shared by every task-graph pass. setThreads() replaces it and sizes the
+    // OpenMP loops (levelization, level sweeps, path search) to the same thread count.
+    TaskExecutor executor;
+    void setThreads(int num_threads, bool pin = false);
+
+    // NUMA placement: node indices are split into one contiguous region per worker, balanced
+    // by nodes plus fanout edges. Worker r owns region r: it first-touches the region's timing
+    // values and fanout edge values, and the executor prefers to run the region's tasks on it.
+    std::vector<int> regionOffsets;
+    std::vector<int> nodeRegion;
+    void partitionRegions();
+    void reportNumaStats(const char *pass) const; // remote-task ratio of the last executor run
+
+    // Timing values indexed by node index, updated lock-free with atomic max/min
+    FirstTouchVector<std::atomic<float>> arrival_time;
+    FirstTouchVector<std::atomic<float>> required_time; // +inf until the node gets a required time
+    FirstTouchVector<std::atomic<float>> early_arrival_time; // min over fanins, +inf at startpoints
+
+    // Early arrival with startpoints at 0, the min-delay counterpart of arrival_time
+    float earlyArrival(int index) const
     {
-        int current_cell_id;  // ID of the current cell
-        int neighbor_cell_id; // ID of the neighbor cell
-        double slew_rate;     // Slew rate value
-    };
-    // Adds a directed edge from 'from' node to 'to' node
-    std::unordered_map<int, float> arrival_time;
+        float early = early_arrival_time[index].load(std::memory_order_relaxed);
+        return std::isinf(early) ? 0.0f : early;
+    }
 
+    // Adds a directed edge from 'from' bit to 'to' bit
     void addEdge(int from, int to);
     void createTaskGraph(const ASIC &asic);
 
@@ -49,24 +101,123 @@ public:
 
     // Builds the DAG based on the provided ASIC object
     void buildFromASIC(const ASIC &asic);
-    void removeCycles(); // Performs topological sort on the DAG and returns the sorted order
-    std::vector<int> topologicalSort(const ASIC &asic, const std::map<int, Cell> &cell_map);
-    void updateArrivalTime(int current, int neighbor, const std::map<int, Cell> &cell_map);
-    double computeRCDelay(const Cell &current_cell, const Cell &neighbor_cell, int current_id, int neighbor_id);
-    double computeSlewRate(const Cell &current_cell, const Cell &neighbor_cell, int current_cell_id, int neighboor_cell_id);
-    std::unordered_map<int, float> analyzeTiming(const ASIC &asic, const std::map<int, Cell> &cell_map, std::vector<int> &sorted);
-    std::unordered_map<int, double> rc_delay_map; // node_id → RC delay
-    std::vector<slewInfo> slew_value;
-    std::vector<rcInfo> rc_value;
-    std::vector<int> topological_TaskGraph(DAG &dag, const std::map<int, Cell> &cell_map, const ASIC &asic);
-    std::map<std::string, std::vector<std::string>> taskGraph;
-    void processQueue(const std::string &task, DAG &dag, const std::map<int, Cell> &cell_map, const ASIC &asic);
+    // Adopts a prebuilt fanout CSR (e.g. from the netlist cache) instead of building one.
+    // Returns false and leaves the graph untouched if the arrays do not form a valid CSR.
+    bool setGraph(std::vector<int> node_ids, std::vector<int> offsets, std::vector<int> targets);
+    // A strongly connected component of the netlist and the edges cut to break it (Yosys bits)
+    struct FeedbackLoop
+    {
+        std::vector<int> nodes;
+        std::vector<std::pair<int, int>> cut_edges;
+    };
+    std::vector<FeedbackLoop> removeCycles(); // Cuts back edges so the graph is acyclic
+    std::vector<int> topologicalSort(const CellStore &cells);
+    void updateArrivalTime(int current, int neighbor, int edge, const CellStore &cells); // node indices
+    double computeRCDelay(const CellStore &cells, int current_cell, int neighbor_cell, int edge); // cell indices
+    double computeSlewRate(const CellStore &cells, int current_cell, int neighbor_cell, int edge);
+    std::unordered_map<int, float> analyzeTiming(const ASIC &asic, const CellStore &cells, std::vector<int> &sorted);
+    // Per-edge timing attributes indexed by edge id
+    FirstTouchVector<double> edge_rc;
+    FirstTouchVector<double> edge_slew;
+    std::vector<int> topological_TaskGraph(DAG &dag, const CellStore &cells, const ASIC &asic);
+
+    // Levelization: levelNodes holds every node sorted by level (longest distance from a
+    // source), level l being levelNodes[levelOffsets[l] .. levelOffsets[l + 1]). The back
+    // arrays do the same with the distance to a sink. Nodes on one level never depend on each
+    // other, so a pass can sweep the levels in order with a parallel loop per level.
+    std::vector<int> levelOffsets;
+    std::vector<int> levelNodes;
+    std::vector<int> backLevelOffsets;
+    std::vector<int> backLevelNodes;
+    void levelize();
+    int numLevels() const { return levelOffsets.empty() ? 0 : static_cast<int>(levelOffsets.size()) - 1; }
+    // Arrival and required times as level sweeps instead of the task graph; returns the bits in level order
+    std::vector<int> levelSweep(const CellStore &cells);
+    // The two halves of levelSweep: arrival times over the forward levels, required times over the back levels
+    void sweepArrivals(const CellStore &cells);
+    void sweepRequired(const CellStore &cells);
+    // Replaces the constant cell delays with NLDM table lookups. A cell's input slew is the worst
+    // output slew among its fanin cells and its load the summed capacitance of its fanout cells;
+    // delays and slews are computed level by level before any timing pass runs.
+    void annotateDelays(CellStore &cells, const NldmLibrary &library);
+
+    // Coarsened task graph: nodes are merged along chains and fanout cones into clusters of at
+    // most clusterLimit nodes. Cluster c holds clusterNodes[clusterOffsets[c] .. clusterOffsets[c + 1])
+    // in topological order; task 2c runs the forward stages of all its nodes and task 2c + 1 their
+    // required times, so the executor schedules far fewer, heavier tasks.
+    std::vector<int> clusterOffsets;
+    std::vector<int> clusterNodes;
+    std::vector<int> clusterTaskOffsets;
+    std::vector<int> clusterTaskTargets;
+    std::vector<int> clusterTaskInDegree;
+    int clusterLimit = 0;
+    void buildClusters(int cluster_size);
+    int numClusters() const { return clusterOffsets.empty() ? 0 : static_cast<int>(clusterOffsets.size()) - 1; }
+    std::vector<int> clusteredTaskGraph(const CellStore &cells, const ASIC &asic);
+
+    // Stages of a node in the task graph. By default the forward stages are fused into the
+    // arrival task (propagateForward), so a node has an arrival and a be_required task; with
+    // stagedForward rc, slew and arrival run as three tasks. task id = node index * stagesPerNode() + slot
+    enum TaskStage
+    {
+        STAGE_RC,
+        STAGE_SLEW,
+        STAGE_ARRIVAL,
+        STAGE_BE_REQUIRED,
+        NUM_STAGES
+    };
+    bool stagedForward = false;
+    int stagesPerNode() const { return stagedForward ? NUM_STAGES : 2; }
+    int taskNode(int task) const { return task / stagesPerNode(); }
+    TaskStage taskStage(int task) const
+    {
+        int slot = task % stagesPerNode();
+        return stagedForward ? static_cast<TaskStage>(slot) : slot ? STAGE_BE_REQUIRED : STAGE_ARRIVAL;
+    }
+    int taskId(int node, TaskStage stage) const
+    {
+        return node * stagesPerNode() + (stagedForward ? static_cast<int>(stage) : (stage == STAGE_BE_REQUIRED ? 1 : 0));
+    }
+    // rc, slew and arrival of every fanout edge of a node in one pass over its CSR row
+    void propagateForward(int node, const CellStore &cells);
+
+    // Task graph in CSR form, successors of task t are taskTargets[taskOffsets[t] .. taskOffsets[t + 1])
+    std::vector<int> taskOffsets;
+    std::vector<int> taskTargets;
+    std::vector<int> taskInDegree;
+
+    int numTasks() const { return numNodes() * stagesPerNode(); }
+    std::string taskName(int task) const;
+    void processQueue(int task, DAG &dag, const CellStore &cells, const ASIC &asic);
     void printTaskGraph();
-    void propagateBeRequired(const Cell &current_cell, int current_id, int fanin_id, const ASIC &asic, const std::map<int, Cell> &cell_map);
-    // std::unordered_map<int, int> required_time;
-    std::unordered_map<int, float> required_time;
-    void initializeRequiredTime(const ASIC &asic, const std::map<int, Cell> &cell_map);
+    void propagateBeRequired(double cell_delay, int current, int fanin, const ASIC &asic); // node indices
+    void initializeRequiredTime(const ASIC &asic);
     std::unordered_map<int, float> computeSlack(const ASIC &asic, const std::vector<int> &sorted);
+    std::unordered_map<int, float> computeHoldSlack(const ASIC &asic); // per endpoint
+
+    // Timing endpoints (Yosys bits): primary outputs and register inputs
+    std::vector<int> endpoints() const;
+    bool isEndpoint(int index) const { return is_output[index] || is_capture[index]; }
+
+    // Incremental (ECO) timing. Edits change the cell store or the graph and mark the nodes whose
+    // timing they affect; updateTiming() then re-evaluates arrival times forward and required
+    // times backward, continuing only through nodes whose value actually changed. Edge edits
+    // are batched and applied to the CSR once per updateTiming() call.
+    bool ecoSetCellType(CellStore &cells, int bit, CellType type); // also updates delay and R/C; not to/from registers
+    bool ecoSetCellDelay(CellStore &cells, int bit, double delay);
+    bool ecoResizeCell(CellStore &cells, int bit, double resistance, double capacitance);
+    bool ecoAddEdge(int from, int to); // bits; false for an edge into a register output
+    void ecoRemoveEdge(int from, int to);
+    int updateTiming(const ASIC &asic, const CellStore &cells); // returns how many arrival/required values changed
+    float slackOf(int bit) const;
+
+    // Multi-corner analysis: all corners are propagated together, one SIMD lane per corner,
+    // in a forward and a backward sweep over the node graph. An empty corner list analyzes nothing.
+    std::vector<Corner> corners;
+    std::vector<CornerTimes> corner_arrival;
+    std::vector<CornerTimes> corner_required; // +inf until the node gets a required time
+    void analyzeCorners(const CellStore &cells, const std::vector<Corner> &corner_list);
+    float cornerSlack(int bit, int corner) const;
 };
 
 #endif // DAG_HPP
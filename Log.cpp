@@ -0,0 +1,27 @@
+#include <iostream>
+#include <mutex>
+#include "Log.hpp"
+
+int log_level = LOG_LEVEL_INFO;
+
+static std::mutex log_mutex;
+
+int parse_log_level(const std::string &name)
+{
+    static const char *names[] = {"error", "warn", "info", "debug", "trace"};
+    for (int level = LOG_LEVEL_ERROR; level <= LOG_LEVEL_TRACE; ++level)
+    {
+        if (name == names[level])
+        {
+            return level;
+        }
+    }
+    return -1;
+}
+
+void log_write(int level, const std::string &line)
+{
+    std::lock_guard<std::mutex> lock(log_mutex);
+    std::ostream &out = level <= LOG_LEVEL_WARN ? std::cerr : std::cout;
+    out << line << '\n';
+}
@@ -0,0 +1,51 @@
+#ifndef LOG_HPP
+#define LOG_HPP
+
+#include <sstream>
+#include <string>
+
+// Log levels. Messages above LOG_COMPILED_LEVEL are removed at compile time, so the
+// hot loops carry no code for them; messages above log_level are skipped at run time.
+#define LOG_LEVEL_ERROR 0 // always shown, written to stderr
+#define LOG_LEVEL_WARN 1  // skipped input, written to stderr
+#define LOG_LEVEL_INFO 2  // one line per phase
+#define LOG_LEVEL_DEBUG 3 // one line per cell, port or net while parsing; region and level stats of the timed passes
+#define LOG_LEVEL_TRACE 4 // one line per task and edge in the timing passes
+
+#ifndef LOG_COMPILED_LEVEL
+#define LOG_COMPILED_LEVEL LOG_LEVEL_TRACE
+#endif
+
+extern int log_level;
+
+// Parses "error", "warn", "info", "debug" or "trace"; returns -1 if unknown
+int parse_log_level(const std::string &name);
+
+// Appends one complete line to the buffered stdout (stderr for errors and warnings).
+// Lines from different threads never interleave.
+void log_write(int level, const std::string &line);
+
+#define LOG_AT(level, msg)                              \
+    do                                                  \
+    {                                                   \
+        if constexpr ((level) <= LOG_COMPILED_LEVEL)    \
+        {                                               \
+            if ((level) <= log_level)                   \
+            {                                           \
+                std::ostringstream log_line_;           \
+                log_line_ << msg;                       \
+                log_write((level), log_line_.str());    \
+            }                                           \
+        }                                               \
+    } while (0)
+
+#define LOG_ERROR(msg) LOG_AT(LOG_LEVEL_ERROR, msg)
+#define LOG_WARN(msg) LOG_AT(LOG_LEVEL_WARN, msg)
+#define LOG_INFO(msg) LOG_AT(LOG_LEVEL_INFO, msg)
+#define LOG_DEBUG(msg) LOG_AT(LOG_LEVEL_DEBUG, msg)
+#define LOG_TRACE(msg) LOG_AT(LOG_LEVEL_TRACE, msg)
+
+// True if messages at this level would be written; guards multi-line dumps
+#define LOG_ENABLED(level) ((level) <= LOG_COMPILED_LEVEL && (level) <= log_level)
+
+#endif // LOG_HPP
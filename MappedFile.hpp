@@ -0,0 +1,55 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Read-only memory mapping of a whole file. data() is null if the file could not be mapped.
+class MappedFile
+{
+private:
+    const char *ptr = nullptr;
+    size_t length = 0;
+
+public:
+    explicit MappedFile(const std::string &path)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return;
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            void *p = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED)
+            {
+                ptr = static_cast<const char *>(p);
+                length = st.st_size;
+            }
+        }
+        ::close(fd);
+    }
+
+    ~MappedFile()
+    {
+        if (ptr)
+        {
+            ::munmap(const_cast<char *>(ptr), length);
+        }
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const char *data() const { return ptr; }
+    size_t size() const { return length; }
+};
+
+#endif // MAPPED_FILE_HPP
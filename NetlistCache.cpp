@@ -0,0 +1,367 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include "NetlistCache.hpp"
+#include "MappedFile.hpp"
+#include "Log.hpp"
+
+using namespace std;
+
+namespace
+{
+    enum CacheSectionId
+    {
+        SEC_CELLS,
+        SEC_PINS,
+        SEC_INPUTS,
+        SEC_OUTPUTS,
+        SEC_NETS,
+        SEC_STRINGS,
+        SEC_NODES,
+        SEC_OFFSETS,
+        SEC_TARGETS,
+        NUM_SECTIONS
+    };
+
+    struct CacheSection
+    {
+        uint64_t offset; // byte offset from the start of the file, 8-byte aligned
+        uint64_t count;  // number of elements
+    };
+
+    struct CacheHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t num_sections;
+        uint64_t source_hash;
+        uint64_t source_size;
+        uint64_t library_hash; // cell_library_hash() of the build that wrote the cache
+        CacheSection sections[NUM_SECTIONS];
+    };
+
+    struct CellRecord
+    {
+        int32_t id;
+        int32_t type;
+        uint32_t first_pin; // inputs, outputs, then data inputs in the pin section
+        uint32_t num_inputs;
+        uint32_t num_outputs;
+        uint32_t num_data_inputs;
+        double delay;
+        double resistance;
+        double capacitance;
+    };
+
+    struct NetRecord
+    {
+        int32_t bit;
+        uint32_t length;
+        uint64_t offset; // into the string table
+    };
+
+    const char CACHE_MAGIC[8] = {'S', 'T', 'A', 'C', 'A', 'C', 'H', 'E'};
+
+    class CacheWriter
+    {
+    private:
+        std::ofstream out;
+        uint64_t position = 0;
+
+    public:
+        explicit CacheWriter(const std::string &path) : out(path, std::ios::binary | std::ios::trunc) {}
+
+        bool ok() const { return static_cast<bool>(out); }
+
+        void raw(const void *data, size_t bytes)
+        {
+            out.write(static_cast<const char *>(data), bytes);
+            position += bytes;
+        }
+
+        template <typename T>
+        CacheSection section(const T *data, size_t count)
+        {
+            static const char zeros[8] = {};
+            raw(zeros, (8 - position % 8) % 8);
+            CacheSection s{position, count};
+            raw(data, count * sizeof(T));
+            return s;
+        }
+
+        void rewrite(const void *data, size_t bytes)
+        {
+            out.seekp(0);
+            out.write(static_cast<const char *>(data), bytes);
+        }
+
+        bool close()
+        {
+            out.close();
+            return ok();
+        }
+    };
+
+    uint64_t fnv1a(uint64_t hash, const void *data, size_t bytes)
+    {
+        const unsigned char *p = static_cast<const unsigned char *>(data);
+        for (size_t i = 0; i < bytes; ++i)
+        {
+            hash = (hash ^ p[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    // The cache holds each cell's delay, R and C and its register data pins, all derived from
+    // CELL_LIBRARY and PIN_ROLES, so a build with a different library must not reuse it
+    uint64_t cell_library_hash()
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (const CellSpec &spec : CELL_LIBRARY)
+        {
+            hash = fnv1a(hash, &spec.type, sizeof(spec.type));
+            hash = fnv1a(hash, spec.name.data(), spec.name.size());
+            hash = fnv1a(hash, &spec.delay, sizeof(spec.delay));
+            hash = fnv1a(hash, &spec.resistance, sizeof(spec.resistance));
+            hash = fnv1a(hash, &spec.capacitance, sizeof(spec.capacitance));
+            hash = fnv1a(hash, &spec.sequential, sizeof(spec.sequential));
+        }
+        for (const PinRoleName &pin : PIN_ROLES)
+        {
+            hash = fnv1a(hash, pin.name.data(), pin.name.size());
+            hash = fnv1a(hash, &pin.role, sizeof(pin.role));
+        }
+        return hash;
+    }
+
+    template <typename T>
+    const T *section_data(const MappedFile &file, const CacheSection &s)
+    {
+        if (s.offset % alignof(T) != 0 || s.offset > file.size() ||
+            s.count > (file.size() - s.offset) / sizeof(T))
+        {
+            return nullptr;
+        }
+        return reinterpret_cast<const T *>(file.data() + s.offset);
+    }
+}
+
+SourceStamp stamp_source_file(const std::string &path)
+{
+    SourceStamp stamp;
+    MappedFile file(path);
+    if (!file.data())
+    {
+        return stamp;
+    }
+
+    // FNV-1a over 8-byte words, then the tail bytes
+    const uint64_t prime = 1099511628211ull;
+    uint64_t hash = 14695981039346656037ull;
+    size_t i = 0;
+    for (; i + 8 <= file.size(); i += 8)
+    {
+        uint64_t word;
+        std::memcpy(&word, file.data() + i, 8);
+        hash = (hash ^ word) * prime;
+    }
+    for (; i < file.size(); ++i)
+    {
+        hash = (hash ^ static_cast<unsigned char>(file.data()[i])) * prime;
+    }
+
+    stamp.hash = hash;
+    stamp.size = file.size();
+    stamp.valid = true;
+    return stamp;
+}
+
+std::string cache_path_for(const std::string &source)
+{
+    return source + ".stacache";
+}
+
+bool write_netlist_cache(const std::string &path, const SourceStamp &stamp, const ASIC &asic, const DAG &dag)
+{
+    std::vector<CellRecord> cells;
+    std::vector<int32_t> pins;
+    cells.reserve(asic.cells.size());
+    for (const Cell &cell : asic.cells)
+    {
+        CellRecord r{};
+        r.id = cell.id;
+        r.type = static_cast<int32_t>(cell.type);
+        r.first_pin = pins.size();
+        r.num_inputs = cell.inputs.size();
+        r.num_outputs = cell.outputs.size();
+        r.num_data_inputs = cell.data_inputs.size();
+        r.delay = cell.delay;
+        r.resistance = cell.resistance;
+        r.capacitance = cell.capacitance;
+        pins.insert(pins.end(), cell.inputs.begin(), cell.inputs.end());
+        pins.insert(pins.end(), cell.outputs.begin(), cell.outputs.end());
+        pins.insert(pins.end(), cell.data_inputs.begin(), cell.data_inputs.end());
+        cells.push_back(r);
+    }
+
+    std::vector<NetRecord> nets;
+    std::string strings;
+    nets.reserve(asic.net_dict.size());
+    for (const auto &[bit, name] : asic.net_dict)
+    {
+        nets.push_back({bit, static_cast<uint32_t>(name.size()), strings.size()});
+        strings += name;
+    }
+
+    // The image is written next to the cache and renamed over it once complete, so an
+    // interrupted --compile never leaves a truncated cache with a valid header behind
+    const std::string temp_path = path + ".tmp";
+    CacheWriter out(temp_path);
+    if (!out.ok())
+    {
+        LOG_WARN("Could not write netlist cache " << path);
+        return false;
+    }
+
+    CacheHeader header{};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = NETLIST_CACHE_VERSION;
+    header.num_sections = NUM_SECTIONS;
+    header.source_hash = stamp.hash;
+    header.source_size = stamp.size;
+    header.library_hash = cell_library_hash();
+    out.raw(&header, sizeof(header));
+
+    header.sections[SEC_CELLS] = out.section(cells.data(), cells.size());
+    header.sections[SEC_PINS] = out.section(pins.data(), pins.size());
+    header.sections[SEC_INPUTS] = out.section(asic.inputs.data(), asic.inputs.size());
+    header.sections[SEC_OUTPUTS] = out.section(asic.outputs.data(), asic.outputs.size());
+    header.sections[SEC_NETS] = out.section(nets.data(), nets.size());
+    header.sections[SEC_STRINGS] = out.section(strings.data(), strings.size());
+    header.sections[SEC_NODES] = out.section(dag.nodeIds.data(), dag.nodeIds.size());
+    header.sections[SEC_OFFSETS] = out.section(dag.fanoutOffsets.data(), dag.fanoutOffsets.size());
+    header.sections[SEC_TARGETS] = out.section(dag.fanoutTargets.data(), dag.fanoutTargets.size());
+    out.rewrite(&header, sizeof(header));
+
+    if (!out.close() || std::rename(temp_path.c_str(), path.c_str()) != 0)
+    {
+        LOG_WARN("Could not write netlist cache " << path);
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool load_netlist_cache(const std::string &path, const SourceStamp &stamp, ASIC &asic, DAG &dag)
+{
+    MappedFile file(path);
+    if (!file.data() || file.size() < sizeof(CacheHeader) || !stamp.valid)
+    {
+        return false;
+    }
+
+    const CacheHeader &header = *reinterpret_cast<const CacheHeader *>(file.data());
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+        header.version != NETLIST_CACHE_VERSION || header.num_sections != NUM_SECTIONS)
+    {
+        LOG_WARN("Ignoring netlist cache " << path << " (unknown format)");
+        return false;
+    }
+    if (header.source_hash != stamp.hash || header.source_size != stamp.size)
+    {
+        LOG_WARN("Ignoring netlist cache " << path << " (source file changed)");
+        return false;
+    }
+    if (header.library_hash != cell_library_hash())
+    {
+        LOG_WARN("Ignoring netlist cache " << path << " (cell library changed)");
+        return false;
+    }
+
+    const CellRecord *cells = section_data<CellRecord>(file, header.sections[SEC_CELLS]);
+    const int32_t *pins = section_data<int32_t>(file, header.sections[SEC_PINS]);
+    const int32_t *inputs = section_data<int32_t>(file, header.sections[SEC_INPUTS]);
+    const int32_t *outputs = section_data<int32_t>(file, header.sections[SEC_OUTPUTS]);
+    const NetRecord *nets = section_data<NetRecord>(file, header.sections[SEC_NETS]);
+    const char *strings = section_data<char>(file, header.sections[SEC_STRINGS]);
+    const int32_t *nodes = section_data<int32_t>(file, header.sections[SEC_NODES]);
+    const int32_t *offsets = section_data<int32_t>(file, header.sections[SEC_OFFSETS]);
+    const int32_t *targets = section_data<int32_t>(file, header.sections[SEC_TARGETS]);
+    if (!cells || !pins || !inputs || !outputs || !nets || !strings || !nodes || !offsets || !targets)
+    {
+        LOG_WARN("Ignoring netlist cache " << path << " (truncated)");
+        return false;
+    }
+
+    const uint64_t num_pins = header.sections[SEC_PINS].count;
+    const uint64_t num_chars = header.sections[SEC_STRINGS].count;
+
+    ASIC loaded;
+    loaded.cells.resize(header.sections[SEC_CELLS].count);
+    for (size_t i = 0; i < loaded.cells.size(); ++i)
+    {
+        const CellRecord &r = cells[i];
+        if (r.first_pin + static_cast<uint64_t>(r.num_inputs) + r.num_outputs + r.num_data_inputs > num_pins)
+        {
+            return false;
+        }
+        Cell &cell = loaded.cells[i];
+        cell.id = r.id;
+        cell.type = static_cast<CellType>(r.type);
+        cell.delay = r.delay;
+        cell.resistance = r.resistance;
+        cell.capacitance = r.capacitance;
+        cell.inputs.assign(pins + r.first_pin, pins + r.first_pin + r.num_inputs);
+        const int32_t *cell_outputs = pins + r.first_pin + r.num_inputs;
+        cell.outputs.assign(cell_outputs, cell_outputs + r.num_outputs);
+        cell.data_inputs.assign(cell_outputs + r.num_outputs, cell_outputs + r.num_outputs + r.num_data_inputs);
+    }
+
+    loaded.inputs.assign(inputs, inputs + header.sections[SEC_INPUTS].count);
+    loaded.outputs.assign(outputs, outputs + header.sections[SEC_OUTPUTS].count);
+
+    for (uint64_t i = 0; i < header.sections[SEC_NETS].count; ++i)
+    {
+        if (nets[i].offset + nets[i].length > num_chars)
+        {
+            return false;
+        }
+        std::string_view name = loaded.net_names.intern(std::string_view(strings + nets[i].offset, nets[i].length));
+        loaded.net_dict.emplace_hint(loaded.net_dict.end(), nets[i].bit, name);
+    }
+
+    // Every node is a pin or port bit, which bounds the bit -> node table setGraph allocates
+    int32_t max_bit = -1;
+    for (uint64_t i = 0; i < num_pins; ++i)
+    {
+        max_bit = std::max(max_bit, pins[i]);
+    }
+    for (int bit : loaded.inputs)
+    {
+        max_bit = std::max(max_bit, bit);
+    }
+    for (int bit : loaded.outputs)
+    {
+        max_bit = std::max(max_bit, bit);
+    }
+
+    const uint64_t num_nodes = header.sections[SEC_NODES].count;
+    for (uint64_t i = 0; i < num_nodes; ++i)
+    {
+        if (nodes[i] > max_bit)
+        {
+            LOG_WARN("Ignoring netlist cache " << path << " (corrupt graph)");
+            return false;
+        }
+    }
+    if (!dag.setGraph(std::vector<int>(nodes, nodes + num_nodes),
+                      std::vector<int>(offsets, offsets + header.sections[SEC_OFFSETS].count),
+                      std::vector<int>(targets, targets + header.sections[SEC_TARGETS].count)))
+    {
+        LOG_WARN("Ignoring netlist cache " << path << " (corrupt graph)");
+        return false;
+    }
+    asic = std::move(loaded);
+    return true;
+}
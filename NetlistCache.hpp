@@ -0,0 +1,31 @@
+#ifndef NETLIST_CACHE_HPP
+#define NETLIST_CACHE_HPP
+
+#include <cstdint>
+#include <string>
+#include "ASIC.hpp"
+#include "DAG.hpp"
+
+// Binary image of a parsed netlist: cells, ports, net names (as a string table) and the
+// cycle-free fanout CSR. Loading it replaces parse_json, assign_rc_to_cells, buildFromASIC
+// and removeCycles. Bump the version whenever the layout or the meaning of a field changes;
+// changes to CELL_LIBRARY or PIN_ROLES invalidate caches through the stored library hash.
+// Sections are copied into the ASIC and DAG on load, and levels are not stored: --levels
+// levelizes the loaded graph as usual.
+#define NETLIST_CACHE_VERSION 4
+
+struct SourceStamp
+{
+    uint64_t hash = 0;
+    uint64_t size = 0;
+    bool valid = false;
+};
+
+// Hashes the source netlist; a cache is only used if its stamp matches
+SourceStamp stamp_source_file(const std::string &path);
+std::string cache_path_for(const std::string &source);
+
+bool write_netlist_cache(const std::string &path, const SourceStamp &stamp, const ASIC &asic, const DAG &dag);
+bool load_netlist_cache(const std::string &path, const SourceStamp &stamp, ASIC &asic, DAG &dag);
+
+#endif // NETLIST_CACHE_HPP
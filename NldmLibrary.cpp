@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include "NldmLibrary.hpp"
+
+// Position of x in an ascending axis: the lower grid index and the fraction towards the next
+// one. Past either end the fraction runs below 0 or above 1, so the lookup extrapolates from the
+// two outermost points as Liberty tools do.
+static void locate(const std::vector<double> &axis, double x, size_t &i, double &t)
+{
+    if (axis.size() < 2)
+    {
+        i = 0;
+        t = 0.0;
+        return;
+    }
+    if (x <= axis.front())
+    {
+        i = 0;
+    }
+    else if (x >= axis.back())
+    {
+        i = axis.size() - 2;
+    }
+    else
+    {
+        i = std::upper_bound(axis.begin(), axis.end(), x) - axis.begin() - 1;
+    }
+    t = (x - axis[i]) / (axis[i + 1] - axis[i]);
+}
+
+double NldmTable::lookup(double slew, double load) const
+{
+    size_t i, j;
+    double s, l;
+    locate(index_1, slew, i, s);
+    locate(index_2, load, j, l);
+
+    const size_t cols = index_2.size();
+    size_t i1 = std::min(i + 1, index_1.size() - 1);
+    size_t j1 = std::min(j + 1, cols - 1);
+    double v00 = values[i * cols + j];
+    double v01 = values[i * cols + j1];
+    double v10 = values[i1 * cols + j];
+    double v11 = values[i1 * cols + j1];
+    return (1 - s) * ((1 - l) * v00 + l * v01) + s * ((1 - l) * v10 + l * v11);
+}
+
+// Bucket of x on an axis cut into NLDM_BUCKETS equal steps between its first and last entry;
+// the steps continue past either end. The bucket is numbered by its upper edge, so x is
+// rounded up: delay and slew rise with slew and load, which keeps a quantized lookup pessimistic.
+static long bucket(const std::vector<double> &axis, double x)
+{
+    if (axis.size() < 2)
+    {
+        return 0;
+    }
+    return static_cast<long>(std::ceil((x - axis.front()) / (axis.back() - axis.front()) * NLDM_BUCKETS));
+}
+
+static double bucketValue(const std::vector<double> &axis, long b)
+{
+    if (axis.size() < 2)
+    {
+        return axis.empty() ? 0.0 : axis.front();
+    }
+    return axis.front() + (axis.back() - axis.front()) * b / NLDM_BUCKETS;
+}
+
+std::pair<double, double> NldmCache::lookup(CellType type, const NldmCell &cell, double slew, double load)
+{
+    // The delay and slew tables share their axes in practice; the delay table's axes define the buckets
+    long slew_bucket = bucket(cell.delay.index_1, slew);
+    long load_bucket = bucket(cell.delay.index_2, load);
+    double s = bucketValue(cell.delay.index_1, slew_bucket);
+    double l = bucketValue(cell.delay.index_2, load_bucket);
+
+    // 20 bits per bucket, centered on the table so extrapolated buckets on both sides fit
+    constexpr long BUCKET_RANGE = 1 << 19;
+    if (std::abs(slew_bucket) >= BUCKET_RANGE || std::abs(load_bucket) >= BUCKET_RANGE)
+    {
+        ++misses;
+        return {cell.delay.lookup(s, l), cell.slew.lookup(s, l)};
+    }
+    uint64_t key = (static_cast<uint64_t>(type) << 40) | (static_cast<uint64_t>(slew_bucket + BUCKET_RANGE) << 20) |
+                   static_cast<uint64_t>(load_bucket + BUCKET_RANGE);
+
+    auto it = memo.find(key);
+    if (it != memo.end())
+    {
+        ++hits;
+        return it->second;
+    }
+    ++misses;
+
+    std::pair<double, double> result{cell.delay.lookup(s, l), cell.slew.lookup(s, l)};
+    memo.emplace(key, result);
+    return result;
+}
+
+static bool read_values(std::istringstream &fields, std::vector<double> &values)
+{
+    double value;
+    size_t before = values.size();
+    while (fields >> value)
+    {
+        values.push_back(value);
+    }
+    return fields.eof() && values.size() > before;
+}
+
+static bool check_table(const NldmTable &table)
+{
+    // Strictly ascending, so interpolation and extrapolation never divide by a zero step
+    return !table.index_1.empty() && !table.index_2.empty() &&
+           std::adjacent_find(table.index_1.begin(), table.index_1.end(), std::greater_equal<double>()) == table.index_1.end() &&
+           std::adjacent_find(table.index_2.begin(), table.index_2.end(), std::greater_equal<double>()) == table.index_2.end() &&
+           table.values.size() == table.index_1.size() * table.index_2.size();
+}
+
+bool load_nldm_library(const std::string &path, NldmLibrary &library, std::string &error)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    library = NldmLibrary();
+    NldmCell *cell = nullptr;
+    std::vector<double> index_1;
+    std::vector<double> index_2;
+    std::string cell_name;
+
+    // A cell is complete when the next one starts or the file ends
+    auto finish = [&]() -> bool
+    {
+        if (!cell)
+        {
+            return true;
+        }
+        cell->delay.index_1 = cell->slew.index_1 = index_1;
+        cell->delay.index_2 = cell->slew.index_2 = index_2;
+        if (!check_table(cell->delay) || !check_table(cell->slew))
+        {
+            error = path + ": cell " + cell_name + " needs ascending index_1/index_2 and a full delay and slew table";
+            return false;
+        }
+        cell->present = true;
+        return true;
+    };
+
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line))
+    {
+        ++line_number;
+        std::istringstream fields(line);
+        std::string keyword;
+        if (!(fields >> keyword) || keyword[0] == '#')
+        {
+            continue;
+        }
+        const std::string where = path + ":" + std::to_string(line_number) + ": ";
+
+        if (keyword == "cell")
+        {
+            if (!finish())
+            {
+                return false;
+            }
+            if (!(fields >> cell_name))
+            {
+                error = where + "expected a cell name";
+                return false;
+            }
+            CellType type = cell_type_from_name(cell_name);
+            if (type == CellType::UNKNOWN)
+            {
+                error = where + "unknown cell " + cell_name;
+                return false;
+            }
+            cell = &library.cells[static_cast<size_t>(type)];
+            *cell = NldmCell();
+            index_1.clear();
+            index_2.clear();
+            continue;
+        }
+        if (keyword == "default_input_slew")
+        {
+            if (!(fields >> library.default_input_slew))
+            {
+                error = where + "expected a value";
+                return false;
+            }
+            continue;
+        }
+        if (!cell)
+        {
+            error = where + keyword + " outside a cell";
+            return false;
+        }
+
+        bool ok;
+        if (keyword == "capacitance")
+        {
+            ok = static_cast<bool>(fields >> cell->capacitance);
+        }
+        else if (keyword == "resistance")
+        {
+            ok = static_cast<bool>(fields >> cell->resistance);
+        }
+        else if (keyword == "index_1")
+        {
+            ok = read_values(fields, index_1);
+        }
+        else if (keyword == "index_2")
+        {
+            ok = read_values(fields, index_2);
+        }
+        else if (keyword == "delay")
+        {
+            ok = read_values(fields, cell->delay.values);
+        }
+        else if (keyword == "slew")
+        {
+            ok = read_values(fields, cell->slew.values);
+        }
+        else
+        {
+            error = where + "unknown keyword " + keyword;
+            return false;
+        }
+        if (!ok)
+        {
+            error = where + "bad values for " + keyword;
+            return false;
+        }
+    }
+    return finish();
+}
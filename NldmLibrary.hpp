@@ -0,0 +1,77 @@
+#ifndef NLDM_LIBRARY_HPP
+#define NLDM_LIBRARY_HPP
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "CellLibrary.hpp"
+
+// Non-linear delay model table: values[i * index_2.size() + j] holds the value at
+// input slew index_1[i] and output load index_2[j]
+struct NldmTable
+{
+    std::vector<double> index_1; // input slew, ascending
+    std::vector<double> index_2; // output load (F), ascending
+    std::vector<double> values;
+
+    // Bilinear interpolation; outside the table it extrapolates from the two outermost points
+    double lookup(double slew, double load) const;
+};
+
+struct NldmCell
+{
+    bool present = false;
+    double capacitance = -1; // input pin capacitance, -1 keeps the built-in value
+    double resistance = -1;  // drive resistance for the wire model, -1 keeps the built-in value
+    NldmTable delay;
+    NldmTable slew; // output transition
+};
+
+// A cell library read from a text file, one entry per CellType. Types the file does not
+// mention keep their built-in constant delay.
+struct NldmLibrary
+{
+    double default_input_slew = 0.0; // slew at primary inputs and register outputs
+    NldmCell cells[NUM_CELL_TYPES];
+
+    const NldmCell *find(CellType type) const
+    {
+        const NldmCell &cell = cells[static_cast<size_t>(type)];
+        return cell.present ? &cell : nullptr;
+    }
+};
+
+// Memo of table lookups keyed by (cell type, slew bucket, load bucket). Inputs are
+// quantized up to the next of NLDM_BUCKETS steps across each table's range (continuing past
+// its ends), and the tables are read at that upper edge. Results never come out below the
+// exact interpolation and do not depend on which thread saw a bucket first. Not thread
+// safe; use one cache per thread.
+constexpr int NLDM_BUCKETS = 256;
+
+class NldmCache
+{
+private:
+    std::unordered_map<uint64_t, std::pair<double, double>> memo;
+
+public:
+    long hits = 0;
+    long misses = 0;
+
+    // Delay and output slew of a cell of this type driving load with the given input slew
+    std::pair<double, double> lookup(CellType type, const NldmCell &cell, double slew, double load);
+};
+
+// Reads a library file:
+//   default_input_slew <value>
+//   cell <name>               (Yosys or liberty cell name, starts a cell)
+//   capacitance <F>           (optional)
+//   resistance <ohm>          (optional)
+//   index_1 <slews...>
+//   index_2 <loads...>
+//   delay <values...>         (one line per index_1 entry, one value per index_2 entry)
+//   slew <values...>          (output transition, same layout)
+// Blank lines and lines starting with '#' are ignored.
+bool load_nldm_library(const std::string &path, NldmLibrary &library, std::string &error);
+
+#endif // NLDM_LIBRARY_HPP
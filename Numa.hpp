@@ -0,0 +1,130 @@
+#ifndef NUMA_HPP
+#define NUMA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <sys/mman.h>
+
+// NUMA node of each CPU, read once from /sys/devices/system/node. Without that
+// directory every CPU counts as node 0.
+inline const std::vector<int> &numa_cpu_nodes()
+{
+    static const std::vector<int> nodes = []
+    {
+        std::vector<int> cpu_node;
+        for (int node = 0;; ++node)
+        {
+            std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            if (!in)
+            {
+                break;
+            }
+
+            // cpulist is a comma separated list of CPUs and ranges, e.g. "0-7,16-23"
+            std::string list;
+            std::getline(in, list);
+            std::stringstream ranges(list);
+            std::string range;
+            while (std::getline(ranges, range, ','))
+            {
+                if (range.empty())
+                {
+                    continue;
+                }
+                size_t dash = range.find('-');
+                int first = std::stoi(range.substr(0, dash));
+                int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+                if (static_cast<int>(cpu_node.size()) <= last)
+                {
+                    cpu_node.resize(last + 1, 0);
+                }
+                for (int cpu = first; cpu <= last; ++cpu)
+                {
+                    cpu_node[cpu] = node;
+                }
+            }
+        }
+        return cpu_node;
+    }();
+    return nodes;
+}
+
+inline int numa_node_of(int cpu)
+{
+    const std::vector<int> &nodes = numa_cpu_nodes();
+    return cpu >= 0 && cpu < static_cast<int>(nodes.size()) ? nodes[cpu] : 0;
+}
+
+inline int numa_node_count()
+{
+    int count = 1;
+    for (int node : numa_cpu_nodes())
+    {
+        count = std::max(count, node + 1);
+    }
+    return count;
+}
+
+// Allocator for arrays that are placed by first touch. Large blocks come straight from
+// mmap, so none of their pages is resident until written, and elements are
+// default-initialized instead of zeroed. The thread that first writes a page decides the
+// NUMA node that holds it.
+template <typename T>
+struct FirstTouchAllocator
+{
+    using value_type = T;
+    static constexpr size_t MMAP_THRESHOLD = 1 << 20;
+
+    FirstTouchAllocator() = default;
+    template <typename U>
+    FirstTouchAllocator(const FirstTouchAllocator<U> &) {}
+
+    T *allocate(size_t n)
+    {
+        size_t bytes = n * sizeof(T);
+        if (bytes < MMAP_THRESHOLD)
+        {
+            return static_cast<T *>(::operator new(bytes));
+        }
+        void *p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED)
+        {
+            throw std::bad_alloc();
+        }
+        return static_cast<T *>(p);
+    }
+
+    void deallocate(T *p, size_t n)
+    {
+        size_t bytes = n * sizeof(T);
+        if (bytes < MMAP_THRESHOLD)
+        {
+            ::operator delete(p);
+        }
+        else
+        {
+            ::munmap(p, bytes);
+        }
+    }
+
+    template <typename U>
+    void construct(U *p) { ::new (static_cast<void *>(p)) U; }
+    template <typename U, typename... Args>
+    void construct(U *p, Args &&...args) { ::new (static_cast<void *>(p)) U(std::forward<Args>(args)...); }
+
+    template <typename U>
+    bool operator==(const FirstTouchAllocator<U> &) const { return true; }
+    template <typename U>
+    bool operator!=(const FirstTouchAllocator<U> &) const { return false; }
+};
+
+template <typename T>
+using FirstTouchVector = std::vector<T, FirstTouchAllocator<T>>;
+
+#endif // NUMA_HPP
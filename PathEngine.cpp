@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
+#include "PathEngine.hpp"
+
+PathEngine::PathEngine(const DAG &dag, const CellStore &cells) : dag(dag)
+{
+    const int n = dag.numNodes();
+    has_cell.assign(n, 0);
+    delay.assign(n, 0.0);
+    for (int node = 0; node < n; ++node)
+    {
+        int cell = cells.find(dag.nodeIds[node]);
+        if (cell >= 0)
+        {
+            has_cell[node] = 1;
+            delay[node] = cells.delay[cell];
+        }
+    }
+
+    // Only edges between two cells carry arrival time, as in updateArrivalTime
+    critical.assign(n, -1);
+    for (int node = 0; node < n; ++node)
+    {
+        if (!has_cell[node])
+        {
+            continue;
+        }
+        float best = -std::numeric_limits<float>::infinity();
+        for (int i = dag.faninOffsets[node]; i < dag.faninOffsets[node + 1]; ++i)
+        {
+            int fanin = dag.faninSources[i];
+            if (!has_cell[fanin])
+            {
+                continue;
+            }
+            float candidate = dag.arrival_time[fanin].load(std::memory_order_relaxed) + edgeDelay(i, node);
+            if (candidate > best)
+            {
+                best = candidate;
+                critical[node] = i;
+            }
+        }
+    }
+}
+
+double PathEngine::edgeDelay(int slot, int node) const
+{
+    int e = dag.faninEdges[slot];
+    return (dag.edge_rc[e] + dag.edge_slew[e]) * 10e9 + delay[node];
+}
+
+float PathEngine::loss(int slot, int node) const
+{
+    float through = dag.arrival_time[dag.faninSources[slot]].load(std::memory_order_relaxed) + edgeDelay(slot, node);
+    return dag.arrival_time[node].load(std::memory_order_relaxed) - through;
+}
+
+std::vector<TimingPath> PathEngine::worstPaths(int endpoint, int k) const
+{
+    std::vector<TimingPath> paths;
+    int target = dag.indexOf(endpoint);
+    if (target < 0 || k <= 0)
+    {
+        return paths;
+    }
+
+    float required = dag.required_time[target].load(std::memory_order_relaxed);
+    if (std::isinf(required))
+    {
+        required = CLOCK_PERIOD;
+    }
+
+    auto by_loss = [](const Candidate &a, const Candidate &b)
+    { return a.loss < b.loss; };
+    std::multiset<Candidate, decltype(by_loss)> candidates(by_loss);
+    candidates.insert({0.0f, -1, target, -1});
+
+    // Node indices of each reported path from the endpoint back to its startpoint
+    std::vector<std::vector<int>> traced;
+
+    while (!candidates.empty() && static_cast<int>(paths.size()) < k)
+    {
+        Candidate next = *candidates.begin();
+        candidates.erase(candidates.begin());
+
+        // Rebuild the path: parent prefix, the deviation edge, then worst fanins
+        std::vector<int> nodes;
+        int node = next.node;
+        if (next.parent >= 0)
+        {
+            const std::vector<int> &prefix = traced[next.parent];
+            nodes.assign(prefix.begin(), std::find(prefix.begin(), prefix.end(), next.node) + 1);
+            node = dag.faninSources[next.slot];
+        }
+        const size_t free_from = nodes.size();
+        while (true)
+        {
+            nodes.push_back(node);
+            if (critical[node] < 0)
+            {
+                break;
+            }
+            node = dag.faninSources[critical[node]];
+        }
+
+        // Deviations are only taken below the last one, so every path is produced once
+        const int reported = static_cast<int>(traced.size());
+        for (size_t p = free_from; p < nodes.size(); ++p)
+        {
+            int x = nodes[p];
+            if (!has_cell[x])
+            {
+                continue;
+            }
+            for (int i = dag.faninOffsets[x]; i < dag.faninOffsets[x + 1]; ++i)
+            {
+                if (i == critical[x] || !has_cell[dag.faninSources[i]])
+                {
+                    continue;
+                }
+
+                Candidate child{next.loss + loss(i, x), reported, x, i};
+                int room = k - static_cast<int>(paths.size()) - 1;
+                if (static_cast<int>(candidates.size()) >= room)
+                {
+                    if (room <= 0 || !by_loss(child, *std::prev(candidates.end())))
+                    {
+                        continue;
+                    }
+                    candidates.erase(std::prev(candidates.end()));
+                }
+                candidates.insert(child);
+            }
+        }
+
+        // Report the path from its startpoint, re-summing the delays as the forward pass does
+        TimingPath path;
+        path.endpoint = endpoint;
+        path.arrival = dag.arrival_time[nodes.back()].load(std::memory_order_relaxed);
+        for (size_t p = nodes.size() - 1; p > 0; --p)
+        {
+            int to = nodes[p - 1];
+            int from = nodes[p];
+            for (int i = dag.faninOffsets[to]; i < dag.faninOffsets[to + 1]; ++i)
+            {
+                if (dag.faninSources[i] == from)
+                {
+                    path.arrival = path.arrival + edgeDelay(i, to);
+                    break;
+                }
+            }
+        }
+        path.slack = required - path.arrival;
+        for (auto it = nodes.rbegin(); it != nodes.rend(); ++it)
+        {
+            path.nodes.push_back(dag.nodeIds[*it]);
+        }
+        paths.push_back(std::move(path));
+        traced.push_back(std::move(nodes));
+    }
+
+    return paths;
+}
+
+std::vector<std::vector<TimingPath>> PathEngine::worstPaths(const std::vector<int> &endpoints, int k, bool parallel) const
+{
+    std::vector<std::vector<TimingPath>> paths(endpoints.size());
+
+#pragma omp parallel for schedule(dynamic) if (parallel)
+    for (size_t i = 0; i < endpoints.size(); ++i)
+    {
+        paths[i] = worstPaths(endpoints[i], k);
+    }
+    return paths;
+}
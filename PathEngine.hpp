@@ -0,0 +1,49 @@
+#ifndef PATH_ENGINE_HPP
+#define PATH_ENGINE_HPP
+
+#include <vector>
+#include "DAG.hpp"
+
+struct TimingPath
+{
+    int endpoint;           // Yosys bit
+    float arrival;          // arrival time at the endpoint along this path
+    float slack;            // endpoint required time minus arrival
+    std::vector<int> nodes; // Yosys bits from the startpoint to the endpoint
+};
+
+// K worst paths per endpoint from the arrival times of a completed forward pass.
+// Every edge into a node loses some arrival against the node's worst fanin; a path's
+// arrival is the endpoint arrival minus the losses of the edges it takes. Paths are
+// found in order of increasing loss as deviations from already reported paths, so the
+// search keeps at most K candidates instead of enumerating every path.
+class PathEngine
+{
+public:
+    PathEngine(const DAG &dag, const CellStore &cells);
+
+    std::vector<TimingPath> worstPaths(int endpoint, int k) const;
+    // Endpoints are searched concurrently when parallel is set
+    std::vector<std::vector<TimingPath>> worstPaths(const std::vector<int> &endpoints, int k, bool parallel = true) const;
+
+private:
+    // A path not yet reported: the reported path 'parent' up to 'node', then into 'node'
+    // through fanin slot 'slot', then the worst fanins back to a startpoint
+    struct Candidate
+    {
+        float loss;
+        int parent; // index into the reported paths, -1 for the endpoint's worst path
+        int node;
+        int slot;
+    };
+
+    const DAG &dag;
+    std::vector<char> has_cell;
+    std::vector<double> delay;
+    std::vector<int> critical; // fanin slot on the worst path into each node, -1 at startpoints
+
+    double edgeDelay(int slot, int node) const;
+    float loss(int slot, int node) const;
+};
+
+#endif // PATH_ENGINE_HPP
@@ -0,0 +1,56 @@
+#ifndef STRING_TABLE_HPP
+#define STRING_TABLE_HPP
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+// Interned strings. Each distinct string is copied once into large blocks that never move,
+// so the views intern() returns stay valid while any copy of the table is alive (copies
+// share the blocks).
+class StringTable
+{
+private:
+    static constexpr size_t BLOCK_SIZE = 64 << 10;
+
+    struct Storage
+    {
+        std::vector<std::unique_ptr<char[]>> blocks;
+        size_t used = BLOCK_SIZE; // bytes used in the last block
+        std::unordered_set<std::string_view> index;
+    };
+    std::shared_ptr<Storage> storage = std::make_shared<Storage>();
+
+public:
+    // The table's copy of text, added on first use
+    std::string_view intern(std::string_view text)
+    {
+        Storage &s = *storage;
+        auto it = s.index.find(text);
+        if (it != s.index.end())
+        {
+            return *it;
+        }
+
+        if (s.blocks.empty() || s.used + text.size() > BLOCK_SIZE)
+        {
+            // Oversized strings get a block of their own, which also counts as full
+            s.blocks.push_back(std::make_unique<char[]>(std::max(BLOCK_SIZE, text.size())));
+            s.used = 0;
+        }
+        char *dest = s.blocks.back().get() + s.used;
+        s.used = text.size() > BLOCK_SIZE ? BLOCK_SIZE : s.used + text.size();
+        std::memcpy(dest, text.data(), text.size());
+
+        std::string_view stored(dest, text.size());
+        s.index.insert(stored);
+        return stored;
+    }
+
+    size_t size() const { return storage->index.size(); }
+};
+
+#endif // STRING_TABLE_HPP
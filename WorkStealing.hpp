@@ -0,0 +1,329 @@
+#ifndef WORK_STEALING_HPP
+#define WORK_STEALING_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <omp.h>
+#include <pthread.h>
+#include <sched.h>
+#include "Numa.hpp"
+
+// Chase-Lev work-stealing deque (Le et al., "Correct and Efficient Work-Stealing
+// for Weak Memory Models"). The owner pushes and pops at the bottom, thieves steal
+// from the top. The buffer grows on demand; retired buffers are kept until the
+// deque is destroyed so concurrent thieves never read freed memory.
+template <typename T>
+class ChaseLevDeque
+{
+private:
+    struct Buffer
+    {
+        int64_t capacity;
+        std::unique_ptr<std::atomic<T>[]> slots;
+
+        explicit Buffer(int64_t cap) : capacity(cap), slots(new std::atomic<T>[cap]) {}
+
+        T get(int64_t i) const { return slots[i & (capacity - 1)].load(std::memory_order_relaxed); }
+        void put(int64_t i, T value) { slots[i & (capacity - 1)].store(value, std::memory_order_relaxed); }
+    };
+
+    std::atomic<int64_t> top{0};
+    std::atomic<int64_t> bottom{0};
+    std::atomic<Buffer *> buffer;
+    std::vector<std::unique_ptr<Buffer>> buffers; // owned by the deque, last one is current
+
+    Buffer *grow(Buffer *old, int64_t b, int64_t t)
+    {
+        buffers.emplace_back(new Buffer(old->capacity * 2));
+        Buffer *bigger = buffers.back().get();
+        for (int64_t i = t; i < b; ++i)
+        {
+            bigger->put(i, old->get(i));
+        }
+        buffer.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+
+public:
+    explicit ChaseLevDeque(int64_t capacity = 1024)
+    {
+        int64_t cap = 1;
+        while (cap < capacity)
+        {
+            cap <<= 1;
+        }
+        buffers.emplace_back(new Buffer(cap));
+        buffer.store(buffers.back().get(), std::memory_order_relaxed);
+    }
+
+    ChaseLevDeque(const ChaseLevDeque &) = delete;
+    ChaseLevDeque &operator=(const ChaseLevDeque &) = delete;
+
+    // Owner only
+    void push(T value)
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        Buffer *a = buffer.load(std::memory_order_relaxed);
+        if (b - t > a->capacity - 1)
+        {
+            a = grow(a, b, t);
+        }
+        a->put(b, value);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // Owner only
+    bool pop(T &out)
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        Buffer *a = buffer.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+
+        if (t > b)
+        {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        out = a->get(b);
+        if (t == b)
+        {
+            // Last element: race against thieves for it
+            bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    // Any thread
+    bool steal(T &out)
+    {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_acquire);
+
+        if (t >= b)
+        {
+            return false;
+        }
+
+        Buffer *a = buffer.load(std::memory_order_acquire);
+        T value = a->get(t);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            return false;
+        }
+        out = value;
+        return true;
+    }
+};
+
+// Dependency-driven executor for task graphs in CSR form. A task is pushed onto the
+// deque of the thread that releases its last dependency the moment its in-degree hits
+// zero; idle threads steal from random victims. There are no per-wave barriers.
+// The worker count is fixed at construction and the deques are reused by every run,
+// so repeated passes only pay for the tasks themselves. With pinning, worker tid is
+// bound to the tid-th CPU the process may run on (wrapping around).
+//
+// Tasks may name the worker that owns their data. They are then seeded on that
+// worker's deque, idle workers steal from workers on their own NUMA node first, and
+// stats counts the tasks that ran on a different node than their owner.
+class TaskExecutor
+{
+public:
+    struct Stats
+    {
+        int tasks = 0;
+        int remote = 0; // tasks run on another NUMA node than the worker owning them
+    };
+    Stats stats;
+
+private:
+    int num_threads = 1;
+    bool pin = false;
+    std::vector<int> cpus;
+    std::vector<int> worker_node; // NUMA node each worker ran on in the last parallel region
+    std::vector<std::unique_ptr<ChaseLevDeque<int>>> deques;
+
+    // Pins the calling worker if requested and records its NUMA node
+    void enter(int tid)
+    {
+        if (pin)
+        {
+            pinWorker(tid);
+        }
+        worker_node[tid] = numa_node_of(pin && !cpus.empty() ? cpus[tid % cpus.size()] : sched_getcpu());
+    }
+
+    void pinWorker(int tid) const
+    {
+        if (cpus.empty())
+        {
+            return;
+        }
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpus[tid % cpus.size()], &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+
+public:
+    // num_threads <= 0 uses the OpenMP default (OMP_NUM_THREADS or the core count)
+    explicit TaskExecutor(int threads = 0, bool pin_threads = false) : pin(pin_threads)
+    {
+        num_threads = threads > 0 ? threads : omp_get_max_threads();
+        worker_node.assign(num_threads, 0);
+        for (int i = 0; i < num_threads; ++i)
+        {
+            deques.emplace_back(new ChaseLevDeque<int>());
+        }
+
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (pin && sched_getaffinity(0, sizeof(allowed), &allowed) == 0)
+        {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            {
+                if (CPU_ISSET(cpu, &allowed))
+                {
+                    cpus.push_back(cpu);
+                }
+            }
+        }
+    }
+
+    int numThreads() const { return num_threads; }
+    bool pinned() const { return pin; }
+
+    // Runs fn(worker) once for every worker, e.g. to first-touch each worker's share of an
+    // array. OpenMP may start fewer threads than workers (OMP_THREAD_LIMIT, OMP_DYNAMIC); the
+    // threads it does start then take over the missing workers' calls.
+    template <typename Fn>
+    void forEachWorker(Fn &&fn)
+    {
+#pragma omp parallel num_threads(num_threads)
+        {
+            const int tid = omp_get_thread_num();
+            enter(tid);
+            for (int worker = tid; worker < num_threads; worker += omp_get_num_threads())
+            {
+                fn(worker);
+            }
+        }
+    }
+
+    // Runs every task of the graph; process(task, tid) runs one task. Returns the number
+    // of tasks executed, which is less than the task count only if the graph has a cycle.
+    template <typename Fn>
+    int run(const std::vector<int> &offsets, const std::vector<int> &targets,
+            const std::vector<int> &inDegree, Fn &&process)
+    {
+        return run(offsets, targets, inDegree, process, [](int) { return -1; });
+    }
+
+    // As above; owner(task) is the worker whose data the task touches, or -1 for none
+    template <typename Fn, typename Owner>
+    int run(const std::vector<int> &offsets, const std::vector<int> &targets,
+            const std::vector<int> &inDegree, Fn &&process, Owner &&owner)
+    {
+        const int num_tasks = static_cast<int>(inDegree.size());
+        std::unique_ptr<std::atomic<int>[]> pending(new std::atomic<int>[num_tasks]);
+
+        // ready = tasks pushed but not yet finished. Successors are counted before their
+        // parent finishes, so ready only reaches zero once no more work can appear.
+        std::atomic<int> ready{0};
+        std::atomic<int> executed{0};
+        std::atomic<int> remote{0};
+
+        int seeded = 0;
+        for (int task = 0; task < num_tasks; ++task)
+        {
+            pending[task].store(inDegree[task], std::memory_order_relaxed);
+            if (inDegree[task] == 0)
+            {
+                int w = owner(task);
+                deques[(w >= 0 ? w : seeded) % num_threads]->push(task);
+                ++seeded;
+            }
+        }
+        ready.store(seeded, std::memory_order_relaxed);
+
+#pragma omp parallel num_threads(num_threads)
+        {
+            const int tid = omp_get_thread_num();
+            enter(tid);
+            ChaseLevDeque<int> &own = *deques[tid];
+            uint32_t rng = 2654435761u * (tid + 1);
+            int local_executed = 0;
+            int local_remote = 0;
+
+#pragma omp barrier
+            std::vector<int> near; // other workers on this worker's NUMA node
+            for (int w = 0; w < num_threads; ++w)
+            {
+                if (w != tid && worker_node[w] == worker_node[tid])
+                {
+                    near.push_back(w);
+                }
+            }
+
+            while (ready.load(std::memory_order_acquire) > 0)
+            {
+                int task;
+                bool found = own.pop(task);
+
+                for (int attempt = 0; !found && attempt < 2 * num_threads; ++attempt)
+                {
+                    rng ^= rng << 13;
+                    rng ^= rng >> 17;
+                    rng ^= rng << 5;
+                    int victim = attempt < num_threads && !near.empty() ? near[rng % near.size()] : rng % num_threads;
+                    if (victim != tid)
+                    {
+                        found = deques[victim]->steal(task);
+                    }
+                }
+
+                if (!found)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                process(task, tid);
+                ++local_executed;
+                int w = owner(task);
+                local_remote += w >= 0 && worker_node[w % num_threads] != worker_node[tid];
+
+                for (int e = offsets[task]; e < offsets[task + 1]; ++e)
+                {
+                    int successor = targets[e];
+                    if (pending[successor].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    {
+                        ready.fetch_add(1, std::memory_order_relaxed);
+                        own.push(successor);
+                    }
+                }
+
+                ready.fetch_sub(1, std::memory_order_acq_rel);
+            }
+
+            executed.fetch_add(local_executed, std::memory_order_relaxed);
+            remote.fetch_add(local_remote, std::memory_order_relaxed);
+        }
+
+        stats.tasks = executed.load();
+        stats.remote = remote.load();
+        return executed.load();
+    }
+};
+
+#endif // WORK_STEALING_HPP
@@ -0,0 +1,766 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string_view>
+#include <omp.h>
+#include "YosysLoader.hpp"
+#include "Log.hpp"
+
+using namespace std;
+
+bool YosysSaxHandler::start_object(std::size_t)
+{
+    if (stack.empty())
+    {
+        stack.push_back(Ctx::Root);
+        return true;
+    }
+
+    Ctx next = Ctx::Skip;
+    switch (stack.back())
+    {
+    case Ctx::Root:
+        if (last_key == "modules")
+        {
+            next = Ctx::Modules;
+        }
+        break;
+    case Ctx::Modules:
+        next = Ctx::Module;
+        ++modules_found;
+        module_name = last_key;
+        module_has_cells = false;
+        LOG_DEBUG("Processing module: " << module_name);
+        break;
+    case Ctx::Module:
+        if (last_key == "cells")
+        {
+            next = Ctx::Cells;
+            module_has_cells = true;
+        }
+        else if (last_key == "ports")
+        {
+            next = Ctx::Ports;
+        }
+        else if (last_key == "netnames")
+        {
+            next = Ctx::Netnames;
+        }
+        break;
+    case Ctx::Cells:
+        next = Ctx::Cell;
+        cell_type = {};
+        cell_directions.clear();
+        cell_connections.clear();
+        cell_bits.clear();
+        cell_has_directions = false;
+        break;
+    case Ctx::Cell:
+        if (last_key == "port_directions")
+        {
+            next = Ctx::PortDirections;
+            cell_has_directions = true;
+        }
+        else if (last_key == "connections")
+        {
+            next = Ctx::Connections;
+        }
+        break;
+    case Ctx::Ports:
+        next = Ctx::Port;
+        module_ports.push_back({symbols.intern(last_key), {}, port_bits.size(), port_bits.size()});
+        break;
+    case Ctx::Netnames:
+        next = Ctx::Netname;
+        module_nets.push_back({asic.net_names.intern(last_key), net_bits.size(), net_bits.size()});
+        break;
+    default:
+        break;
+    }
+
+    stack.push_back(next);
+    return true;
+}
+
+bool YosysSaxHandler::start_array(std::size_t)
+{
+    Ctx next = Ctx::Skip;
+    if (!stack.empty())
+    {
+        switch (stack.back())
+        {
+        case Ctx::Connections:
+            next = Ctx::ConnectionBits;
+            cell_connections.push_back({symbols.intern(last_key), cell_bits.size(), cell_bits.size()});
+            break;
+        case Ctx::Port:
+            if (last_key == "bits")
+            {
+                next = Ctx::PortBits;
+            }
+            break;
+        case Ctx::Netname:
+            if (last_key == "bits")
+            {
+                next = Ctx::NetBits;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    stack.push_back(next);
+    return true;
+}
+
+bool YosysSaxHandler::end_object()
+{
+    Ctx done = stack.back();
+    stack.pop_back();
+
+    if (done == Ctx::Cell)
+    {
+        finishCell();
+    }
+    else if (done == Ctx::Cells && parsed_cells)
+    {
+        spliceParsedCells();
+    }
+    else if (done == Ctx::Module)
+    {
+        finishModule();
+    }
+    else if (done == Ctx::Modules)
+    {
+        LOG_INFO("Modules found: " << modules_found);
+    }
+    return true;
+}
+
+bool YosysSaxHandler::end_array()
+{
+    stack.pop_back();
+    return true;
+}
+
+bool YosysSaxHandler::key(string_t &val)
+{
+    last_key = val;
+    return true;
+}
+
+bool YosysSaxHandler::string(string_t &val)
+{
+    if (stack.empty())
+    {
+        return true;
+    }
+
+    switch (stack.back())
+    {
+    case Ctx::Cell:
+        if (last_key == "type")
+        {
+            cell_type = symbols.intern(val);
+        }
+        break;
+    case Ctx::PortDirections:
+        cell_directions.emplace_back(symbols.intern(last_key), symbols.intern(val));
+        break;
+    case Ctx::Port:
+        if (last_key == "direction")
+        {
+            module_ports.back().direction = symbols.intern(val);
+        }
+        break;
+    case Ctx::ConnectionBits:
+        cell_bits.push_back(constant(val));
+        cell_connections.back().last = cell_bits.size();
+        break;
+    case Ctx::PortBits:
+        port_bits.push_back(constant(val));
+        module_ports.back().last = port_bits.size();
+        break;
+    case Ctx::NetBits:
+        net_bits.push_back(constant(val));
+        module_nets.back().last = net_bits.size();
+        break;
+    default:
+        break;
+    }
+    return true;
+}
+
+bool YosysSaxHandler::number(long long val)
+{
+    if (stack.empty())
+    {
+        return true;
+    }
+
+    Bit bit{static_cast<int>(val), true};
+    switch (stack.back())
+    {
+    case Ctx::ConnectionBits:
+        cell_bits.push_back(bit);
+        cell_connections.back().last = cell_bits.size();
+        break;
+    case Ctx::PortBits:
+        port_bits.push_back(bit);
+        module_ports.back().last = port_bits.size();
+        break;
+    case Ctx::NetBits:
+        net_bits.push_back(bit);
+        module_nets.back().last = net_bits.size();
+        break;
+    default:
+        break;
+    }
+    return true;
+}
+
+bool YosysSaxHandler::parse_error(std::size_t, const std::string &, const nlohmann::detail::exception &ex)
+{
+    error_message = ex.what();
+    return false;
+}
+
+void YosysSaxHandler::finishCell()
+{
+    LOG_DEBUG("Processing cell...");
+    LOG_DEBUG("  Cell type: " << cell_type);
+
+    Cell new_cell{};
+    CellType type = parse_cell_type(cell_type);
+    new_cell.type = type;
+    new_cell.delay = get_delay(type);
+
+    // Connections are handled in name order, like iterating the JSON object did
+    std::stable_sort(cell_connections.begin(), cell_connections.end(),
+                     [](const Connection &a, const Connection &b)
+                     { return a.name < b.name; });
+
+    for (const Connection &c : cell_connections)
+    {
+        std::string_view connection = c.name;
+        LOG_DEBUG("  Processing connection: " << connection);
+
+        if (!cell_has_directions)
+        {
+            LOG_WARN("Cell missing 'port_directions' field. Skipping...");
+            continue;
+        }
+
+        auto dir = std::find_if(cell_directions.begin(), cell_directions.end(),
+                                [&](const auto &d)
+                                { return d.first == connection; });
+        if (dir == cell_directions.end())
+        {
+            LOG_WARN("No port direction found for connection '" << connection << "'. Skipping...");
+            continue;
+        }
+
+        std::string_view direction = dir->second;
+        LOG_DEBUG("    Direction: \"" << direction << "\"");
+
+        for (size_t b = c.first; b < c.last; ++b)
+        {
+            const Bit &bit = cell_bits[b];
+            if (!bit.is_number)
+            {
+                LOG_WARN("    Expected number in " << (direction == "input" ? "input" : "output")
+                                                      << " bits but got: \"" << static_cast<char>(bit.value) << "\"");
+                continue;
+            }
+
+            if (direction == "input")
+            {
+                LOG_DEBUG("    Input bit: " << bit.value);
+
+                if (!is_sequential(type) || !is_clock_pin(connection))
+                {
+                    new_cell.inputs.push_back(bit.value);
+                    if (is_sequential(type) && pin_role(connection) == PinRole::DATA)
+                    {
+                        new_cell.data_inputs.push_back(bit.value);
+                    }
+                }
+                else if (std::find(clocks.begin(), clocks.end(), bit.value) == clocks.end())
+                {
+                    clocks.push_back(bit.value);
+                }
+            }
+            else // output
+            {
+                LOG_DEBUG("    Output bit: " << bit.value);
+                new_cell.outputs.push_back(bit.value);
+            }
+        }
+    }
+
+    new_cell.id = new_cell.outputs.empty() ? -1 : new_cell.outputs[0];
+
+    asic.cells.push_back(std::move(new_cell));
+    LOG_DEBUG("  Cell added. ID: " << asic.cells.back().id);
+}
+
+void YosysSaxHandler::spliceParsedCells()
+{
+    if (parsed_cells_used >= parsed_cells->size())
+    {
+        return;
+    }
+
+    ParsedCells &parsed = (*parsed_cells)[parsed_cells_used++];
+    asic.cells.insert(asic.cells.end(), std::make_move_iterator(parsed.cells.begin()),
+                      std::make_move_iterator(parsed.cells.end()));
+    for (int clock : parsed.clocks)
+    {
+        if (std::find(clocks.begin(), clocks.end(), clock) == clocks.end())
+        {
+            clocks.push_back(clock);
+        }
+    }
+    parsed.cells.clear();
+}
+
+bool YosysSaxHandler::parseCell(const char *begin, const char *end)
+{
+    stack.assign(1, Ctx::Cells);
+    return nlohmann::json::sax_parse(begin, end, this);
+}
+
+void YosysSaxHandler::finishModule()
+{
+    if (!module_has_cells)
+    {
+        LOG_DEBUG("No cells in module: " << module_name);
+        module_ports.clear();
+        module_nets.clear();
+        port_bits.clear();
+        net_bits.clear();
+        return;
+    }
+
+    // Ports and net names are applied in name order, like iterating the JSON object did
+    auto by_name = [](const auto &a, const auto &b)
+    { return a.name < b.name; };
+    std::stable_sort(module_ports.begin(), module_ports.end(), by_name);
+    std::stable_sort(module_nets.begin(), module_nets.end(), by_name);
+
+    LOG_DEBUG("Processing ports...");
+    for (const PendingPort &port : module_ports)
+    {
+        LOG_DEBUG("  Port: " << port.name);
+        LOG_DEBUG("    Direction: \"" << port.direction << "\"");
+
+        for (size_t b = port.first; b < port.last; ++b)
+        {
+            const Bit &bit = port_bits[b];
+            if (!bit.is_number)
+            {
+                LOG_WARN("    Expected number in port bits but got: \"" << static_cast<char>(bit.value) << "\"");
+                continue;
+            }
+
+            LOG_DEBUG("    Bit: " << bit.value);
+
+            if (port.direction == "input")
+            {
+                if (std::find(clocks.begin(), clocks.end(), bit.value) == clocks.end())
+                {
+                    asic.inputs.push_back(bit.value);
+                }
+            }
+            else
+            {
+                asic.outputs.push_back(bit.value);
+            }
+        }
+    }
+
+    LOG_DEBUG("Processing netnames...");
+    for (const PendingNet &net : module_nets)
+    {
+        LOG_DEBUG("  Netname: " << net.name);
+
+        const size_t width = net.last - net.first;
+        for (size_t i = 0; i < width; i++)
+        {
+            const Bit &bit = net_bits[net.first + i];
+            if (!bit.is_number)
+            {
+                LOG_WARN("    Netname bit is not a number: \"" << static_cast<char>(bit.value) << "\"");
+                continue;
+            }
+
+            if (width == 1)
+            {
+                asic.net_dict[bit.value] = net.name;
+            }
+            else
+            {
+                scratch.assign(net.name);
+                scratch += '[';
+                scratch += std::to_string(i);
+                scratch += ']';
+                asic.net_dict[bit.value] = asic.net_names.intern(scratch);
+            }
+        }
+    }
+
+    module_ports.clear();
+    module_nets.clear();
+    port_bits.clear();
+    net_bits.clear();
+}
+
+bool load_yosys_json(std::istream &in, ASIC &asic, std::string &error)
+{
+    YosysSaxHandler handler(asic);
+    if (!nlohmann::json::sax_parse(in, &handler))
+    {
+        error = handler.error();
+        asic = ASIC();
+        return false;
+    }
+    return true;
+}
+
+namespace
+{
+    // Byte ranges of the cell objects inside one module's "cells" object, which spans
+    // [begin, end) of the document
+    struct CellsSpan
+    {
+        size_t begin;
+        size_t end;
+        std::vector<std::pair<size_t, size_t>> cells;
+    };
+
+    // Structural scan of a Yosys document that only tracks strings and nesting. It follows the
+    // same path as the SAX handler (root -> "modules" -> module -> "cells") and gives up on
+    // anything it does not expect; the full parser then reports the error.
+    class CellsScanner
+    {
+    private:
+        const char *data;
+        size_t size;
+        size_t pos = 0;
+
+        void skipSpace()
+        {
+            while (pos < size && (data[pos] == ' ' || data[pos] == '\n' || data[pos] == '\r' || data[pos] == '\t'))
+            {
+                ++pos;
+            }
+        }
+
+        bool peek(char c)
+        {
+            skipSpace();
+            return pos < size && data[pos] == c;
+        }
+
+        bool expect(char c)
+        {
+            if (!peek(c))
+            {
+                return false;
+            }
+            ++pos;
+            return true;
+        }
+
+        // Skips a string starting at its opening quote; the raw bytes between the quotes go to text
+        bool skipString(const char *&text, size_t &length)
+        {
+            if (!expect('"'))
+            {
+                return false;
+            }
+            size_t start = pos;
+            while (pos < size && data[pos] != '"')
+            {
+                pos += data[pos] == '\\' ? 2 : 1;
+            }
+            if (pos >= size)
+            {
+                return false;
+            }
+            text = data + start;
+            length = pos - start;
+            ++pos;
+            return true;
+        }
+
+        bool skipValue()
+        {
+            skipSpace();
+            if (pos >= size)
+            {
+                return false;
+            }
+            const char *text;
+            size_t length;
+            if (data[pos] == '"')
+            {
+                return skipString(text, length);
+            }
+            if (data[pos] != '{' && data[pos] != '[')
+            {
+                while (pos < size && !std::strchr(",}] \n\r\t", data[pos]))
+                {
+                    ++pos;
+                }
+                return true;
+            }
+
+            int depth = 0;
+            while (pos < size)
+            {
+                char c = data[pos];
+                if (c == '"')
+                {
+                    if (!skipString(text, length))
+                    {
+                        return false;
+                    }
+                    continue;
+                }
+                ++pos;
+                if (c == '{' || c == '[')
+                {
+                    ++depth;
+                }
+                else if ((c == '}' || c == ']') && --depth == 0)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Walks the members of an object, calling member(key, key_length) positioned at each value;
+        // member must consume the value
+        template <typename Member>
+        bool members(Member member)
+        {
+            if (!expect('{'))
+            {
+                return false;
+            }
+            if (expect('}'))
+            {
+                return true;
+            }
+            do
+            {
+                const char *key;
+                size_t length;
+                if (!skipString(key, length) || !expect(':') || !member(std::string_view(key, length)))
+                {
+                    return false;
+                }
+            } while (expect(','));
+            return expect('}');
+        }
+
+        bool cells(std::vector<CellsSpan> &spans)
+        {
+            CellsSpan span{pos, 0, {}};
+            bool ok = members([&](std::string_view)
+                              {
+                                  skipSpace();
+                                  size_t start = pos;
+                                  if (!skipValue())
+                                  {
+                                      return false;
+                                  }
+                                  span.cells.emplace_back(start, pos);
+                                  return true; });
+            span.end = pos;
+            spans.push_back(std::move(span));
+            return ok;
+        }
+
+    public:
+        CellsScanner(const char *data, size_t size) : data(data), size(size) {}
+
+        bool scan(std::vector<CellsSpan> &spans)
+        {
+            return members([&](std::string_view key)
+                           {
+                if (key != "modules" || !peek('{'))
+                {
+                    return skipValue();
+                }
+                return members([&](std::string_view)
+                               {
+                    if (!peek('{'))
+                    {
+                        return skipValue();
+                    }
+                    return members([&](std::string_view module_key)
+                                   { return module_key == "cells" && peek('{') ? cells(spans) : skipValue(); }); }); });
+        }
+    };
+
+    // Reads the document with every "cells" object replaced by {}, straight from the mapped
+    // bytes: the parser gets the segments between the spans without a copy of the document
+    class SkeletonIterator
+    {
+    private:
+        const char *data;
+        size_t pos;
+        const std::vector<CellsSpan> *spans;
+        size_t span = 0;     // next span at or after pos
+        int placeholder = 0; // characters of "{}" already read at that span
+        size_t next_begin = SIZE_MAX;
+
+        void findNext()
+        {
+            next_begin = span < spans->size() ? (*spans)[span].begin : SIZE_MAX;
+        }
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = char;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const char *;
+        using reference = const char &;
+
+        SkeletonIterator(const char *data, size_t pos, const std::vector<CellsSpan> &spans)
+            : data(data), pos(pos), spans(&spans)
+        {
+            findNext();
+        }
+
+        char operator*() const
+        {
+            return pos == next_begin ? "{}"[placeholder] : data[pos];
+        }
+
+        SkeletonIterator &operator++()
+        {
+            if (pos != next_begin)
+            {
+                ++pos;
+            }
+            else if (++placeholder == 2)
+            {
+                placeholder = 0;
+                pos = (*spans)[span++].end;
+                findNext();
+            }
+            return *this;
+        }
+
+        bool operator==(const SkeletonIterator &other) const { return pos == other.pos && placeholder == other.placeholder; }
+        bool operator!=(const SkeletonIterator &other) const { return !(*this == other); }
+    };
+
+    bool parse_whole(const char *data, size_t size, ASIC &asic, std::string &error)
+    {
+        YosysSaxHandler handler(asic);
+        if (!nlohmann::json::sax_parse(data, data + size, &handler))
+        {
+            error = handler.error();
+            asic = ASIC();
+            return false;
+        }
+        return true;
+    }
+}
+
+bool load_yosys_json(const char *data, size_t size, ASIC &asic, std::string &error)
+{
+    std::vector<CellsSpan> spans;
+    int threads = omp_get_max_threads();
+    if (threads > 1 && !CellsScanner(data, size).scan(spans))
+    {
+        spans.clear();
+    }
+
+    size_t total_cells = 0;
+    for (const CellsSpan &span : spans)
+    {
+        total_cells += span.cells.size();
+    }
+    if (total_cells == 0)
+    {
+        return parse_whole(data, size, asic, error);
+    }
+
+    // Chunks of consecutive cells within one span, a few per thread so uneven cells balance out
+    struct Chunk
+    {
+        size_t span;
+        size_t first;
+        size_t last;
+        ASIC asic;
+        std::vector<int> clocks;
+        std::string error;
+    };
+    size_t chunk_size = std::max<size_t>(64, total_cells / (threads * 4));
+    std::vector<Chunk> chunks;
+    for (size_t s = 0; s < spans.size(); ++s)
+    {
+        for (size_t first = 0; first < spans[s].cells.size(); first += chunk_size)
+        {
+            chunks.push_back({s, first, std::min(first + chunk_size, spans[s].cells.size()), {}, {}, {}});
+        }
+    }
+
+#pragma omp parallel for schedule(dynamic)
+    for (size_t c = 0; c < chunks.size(); ++c)
+    {
+        Chunk &chunk = chunks[c];
+        YosysSaxHandler handler(chunk.asic);
+        for (size_t i = chunk.first; i < chunk.last; ++i)
+        {
+            auto [begin, end] = spans[chunk.span].cells[i];
+            if (!handler.parseCell(data + begin, data + end))
+            {
+                chunk.error = "cell at byte " + std::to_string(begin) + ": " + handler.error();
+                break;
+            }
+        }
+        chunk.clocks = handler.clockBits();
+    }
+
+    std::vector<YosysSaxHandler::ParsedCells> parsed(spans.size());
+    for (Chunk &chunk : chunks)
+    {
+        if (!chunk.error.empty())
+        {
+            error = chunk.error;
+            asic = ASIC();
+            return false;
+        }
+        YosysSaxHandler::ParsedCells &target = parsed[chunk.span];
+        target.cells.insert(target.cells.end(), std::make_move_iterator(chunk.asic.cells.begin()),
+                            std::make_move_iterator(chunk.asic.cells.end()));
+        target.clocks.insert(target.clocks.end(), chunk.clocks.begin(), chunk.clocks.end());
+    }
+
+    // The rest of the document, read around the "cells" objects
+    YosysSaxHandler handler(asic);
+    handler.setParsedCells(&parsed);
+    if (!nlohmann::json::sax_parse(SkeletonIterator(data, 0, spans), SkeletonIterator(data, size, spans), &handler))
+    {
+        error = handler.error();
+        asic = ASIC();
+        return false;
+    }
+    if (handler.parsedCellsUsed() != parsed.size())
+    {
+        // The scan and the parser disagree on where the cells are; parse the document as a whole
+        LOG_WARN("Parallel cell parsing fell back to a serial parse");
+        asic = ASIC();
+        return parse_whole(data, size, asic, error);
+    }
+    return true;
+}
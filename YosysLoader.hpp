@@ -0,0 +1,142 @@
+#ifndef YOSYS_LOADER_HPP
+#define YOSYS_LOADER_HPP
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "ASIC.hpp"
+
+// Streaming loader for Yosys JSON netlists. Builds Cells, ports and net names
+// directly from SAX events, so the JSON document is never materialized.
+class YosysSaxHandler : public nlohmann::json_sax<nlohmann::json>
+{
+public:
+    explicit YosysSaxHandler(ASIC &asic) : asic(asic) {}
+
+    bool null() override { return true; }
+    bool boolean(bool) override { return true; }
+    bool number_integer(number_integer_t val) override { return number(static_cast<long long>(val)); }
+    bool number_unsigned(number_unsigned_t val) override { return number(static_cast<long long>(val)); }
+    bool number_float(number_float_t, const string_t &) override { return true; }
+    bool string(string_t &val) override;
+    bool binary(binary_t &) override { return true; }
+    bool start_object(std::size_t) override;
+    bool key(string_t &val) override;
+    bool end_object() override;
+    bool start_array(std::size_t) override;
+    bool end_array() override;
+    bool parse_error(std::size_t position, const std::string &last_token, const nlohmann::detail::exception &ex) override;
+
+    const std::string &error() const { return error_message; }
+    const std::vector<int> &clockBits() const { return clocks; }
+
+    // Parses a single cell object, the value of one member of a module's "cells", into asic.cells
+    bool parseCell(const char *begin, const char *end);
+
+    // Cells of one "cells" object, parsed apart from the rest of the document
+    struct ParsedCells
+    {
+        std::vector<Cell> cells;
+        std::vector<int> clocks;
+    };
+    // The document's "cells" objects are empty placeholders; the n-th one takes (*parsed)[n]
+    void setParsedCells(std::vector<ParsedCells> *parsed) { parsed_cells = parsed; }
+    size_t parsedCellsUsed() const { return parsed_cells_used; }
+
+private:
+    // Where in the Yosys document the parser currently is
+    enum class Ctx
+    {
+        Root,
+        Modules,
+        Module,
+        Cells,
+        Cell,
+        PortDirections,
+        Connections,
+        ConnectionBits,
+        Ports,
+        Port,
+        PortBits,
+        Netnames,
+        Netname,
+        NetBits,
+        Skip
+    };
+
+    // A bit list entry; constants such as "0" or "x" keep their character in value
+    struct Bit
+    {
+        int value;
+        bool is_number;
+    };
+
+    static Bit constant(const std::string &val) { return {val.empty() ? '?' : val[0], false}; }
+
+    // Names are interned and bits are ranges [first, last) of a shared bit buffer, so a
+    // pending cell, port or net owns no allocation of its own
+    struct Connection
+    {
+        std::string_view name;
+        size_t first;
+        size_t last;
+    };
+
+    struct PendingPort
+    {
+        std::string_view name;
+        std::string_view direction;
+        size_t first;
+        size_t last;
+    };
+
+    struct PendingNet
+    {
+        std::string_view name; // in asic.net_names
+        size_t first;
+        size_t last;
+    };
+
+    ASIC &asic;
+    std::vector<Ctx> stack;
+    std::string last_key;
+    std::string error_message;
+    std::vector<int> clocks; // bits driving register clock pins
+    StringTable symbols;     // cell types, port names and directions
+    std::string scratch;     // bus bit names
+    int modules_found = 0;
+    std::string module_name;
+    bool module_has_cells = false;
+
+    // Current cell
+    std::string_view cell_type;
+    std::vector<std::pair<std::string_view, std::string_view>> cell_directions;
+    std::vector<Connection> cell_connections;
+    std::vector<Bit> cell_bits;
+    bool cell_has_directions = false;
+
+    std::vector<ParsedCells> *parsed_cells = nullptr;
+    size_t parsed_cells_used = 0;
+
+    // Current module; ports are resolved after its cells so the clocks are known
+    std::vector<PendingPort> module_ports;
+    std::vector<PendingNet> module_nets;
+    std::vector<Bit> port_bits;
+    std::vector<Bit> net_bits;
+
+    bool number(long long val);
+    void finishCell();
+    void finishModule();
+    void spliceParsedCells();
+};
+
+// Parses a Yosys JSON stream into asic. Returns false and leaves asic empty on a syntax error.
+bool load_yosys_json(std::istream &in, ASIC &asic, std::string &error);
+
+// Same for a netlist held in memory (e.g. a mapped file). The module "cells" objects are
+// split at cell boundaries and parsed on all threads, then the rest of the document is
+// parsed in place around them with their results spliced in, in document order.
+bool load_yosys_json(const char *data, size_t size, ASIC &asic, std::string &error);
+
+#endif // YOSYS_LOADER_HPP
@@ -0,0 +1,256 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include "DAG.hpp"
+#include "Log.hpp"
+
+using namespace std::chrono;
+
+// Phases timed on every run, in the order they execute. "taskgraph" is the work-stealing pass
+// sta.o uses by default (arrival and required times together); "forward" and "backward" are
+// the two halves of the level sweep, so each direction is timed on its own.
+static const char *PHASES[] = {"parse", "map", "build", "taskgraph", "levelize", "forward", "backward", "slack"};
+constexpr int NUM_PHASES = sizeof(PHASES) / sizeof(PHASES[0]);
+
+static void usage(const char *prog)
+{
+    std::cerr << "Usage: " << prog << " [--threads <n,n,...>] [--reps <n>] [--csv <file>] [--pin] [<filename>...]" << std::endl
+              << "Runs every phase over each netlist (default: circuits/json/*.json) for each thread count" << std::endl;
+}
+
+static std::vector<int> parse_thread_list(const char *list)
+{
+    std::vector<int> threads;
+    std::stringstream in(list);
+    std::string item;
+    while (std::getline(in, item, ','))
+    {
+        int n = atoi(item.c_str());
+        if (n <= 0)
+        {
+            return {};
+        }
+        threads.push_back(n);
+    }
+    return threads;
+}
+
+// One complete analysis of a netlist; returns the time of each phase in microseconds, or
+// nothing if the netlist could not be parsed
+static std::vector<double> run_once(const std::string &filename, int threads, bool pin)
+{
+    std::vector<double> times;
+    auto start = high_resolution_clock::now();
+    auto lap = [&]()
+    {
+        auto now = high_resolution_clock::now();
+        times.push_back(duration_cast<nanoseconds>(now - start).count() / 1000.0);
+        start = now;
+    };
+
+    DAG dag;
+    dag.setThreads(threads, pin);
+    start = high_resolution_clock::now();
+
+    ASIC asic = parse_json(filename);
+    if (asic.cells.empty())
+    {
+        return {};
+    }
+    assign_rc_to_cells(asic);
+    lap();
+
+    CellStore cells = create_cell_store(asic.cells);
+    lap();
+
+    dag.buildFromASIC(asic);
+    dag.removeCycles();
+    dag.reverseList();
+    dag.createTaskGraph(asic);
+    dag.initializeRequiredTime(asic);
+    lap();
+
+    dag.topological_TaskGraph(dag, cells, asic);
+    lap();
+
+    dag.levelize();
+    lap();
+
+    dag.sweepArrivals(cells);
+    lap();
+
+    dag.sweepRequired(cells);
+    lap();
+
+    std::vector<int> sorted;
+    sorted.reserve(dag.levelNodes.size());
+    for (int node : dag.levelNodes)
+    {
+        sorted.push_back(dag.nodeIds[node]);
+    }
+    dag.computeSlack(asic, sorted);
+    lap();
+
+    return times;
+}
+
+// Nearest-rank percentile of a sorted sample
+static double percentile(const std::vector<double> &sorted, double p)
+{
+    size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+int main(int argc, char **argv)
+{
+    std::ios::sync_with_stdio(false);
+
+    std::vector<std::string> files;
+    std::vector<int> thread_counts;
+    int reps = 5;
+    std::string csv_file = "bench.csv";
+    bool pin = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            thread_counts = parse_thread_list(argv[++i]);
+            if (thread_counts.empty())
+            {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc)
+        {
+            reps = atoi(argv[++i]);
+            if (reps <= 0)
+            {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc)
+        {
+            csv_file = argv[++i];
+        }
+        else if (strcmp(argv[i], "--pin") == 0)
+        {
+            pin = true;
+        }
+        else if (argv[i][0] == '-')
+        {
+            usage(argv[0]);
+            return 1;
+        }
+        else
+        {
+            files.push_back(argv[i]);
+        }
+    }
+
+    if (files.empty())
+    {
+        std::error_code ec;
+        for (const auto &entry : std::filesystem::directory_iterator("circuits/json", ec))
+        {
+            if (entry.path().extension() == ".json")
+            {
+                files.push_back(entry.path().string());
+            }
+        }
+        std::sort(files.begin(), files.end());
+        if (files.empty())
+        {
+            std::cerr << "No netlists found in circuits/json" << std::endl;
+            return 1;
+        }
+    }
+
+    // Default sweep: 1, 2, 4, ... up to the number of cores, always ending at the core count
+    if (thread_counts.empty())
+    {
+        int cores = omp_get_num_procs();
+        for (int n = 1; n < cores; n *= 2)
+        {
+            thread_counts.push_back(n);
+        }
+        thread_counts.push_back(cores);
+    }
+
+    std::ofstream csv(csv_file);
+    if (!csv)
+    {
+        std::cerr << "Cannot write " << csv_file << std::endl;
+        return 1;
+    }
+    csv << "circuit,phase,threads,reps,median_us,p95_us,speedup\n" << std::fixed;
+
+    // Only errors are printed; the timing passes would otherwise log every run
+    log_level = LOG_LEVEL_ERROR;
+
+    for (const std::string &file : files)
+    {
+        std::string circuit = std::filesystem::path(file).stem().string();
+
+        // median[t][phase] and p95[t][phase], in the order of thread_counts
+        std::vector<std::vector<double>> median(thread_counts.size()), p95(thread_counts.size());
+        bool parsed = true;
+        for (size_t t = 0; t < thread_counts.size() && parsed; ++t)
+        {
+            std::vector<std::vector<double>> samples(NUM_PHASES);
+            for (int r = 0; r < reps && parsed; ++r)
+            {
+                std::vector<double> times = run_once(file, thread_counts[t], pin);
+                parsed = !times.empty();
+                for (size_t p = 0; p < times.size(); ++p)
+                {
+                    samples[p].push_back(times[p]);
+                }
+            }
+            for (int p = 0; p < NUM_PHASES && parsed; ++p)
+            {
+                std::sort(samples[p].begin(), samples[p].end());
+                median[t].push_back(percentile(samples[p], 0.5));
+                p95[t].push_back(percentile(samples[p], 0.95));
+            }
+        }
+
+        if (!parsed)
+        {
+            std::cerr << "Skipping " << file << ": no cells parsed" << std::endl;
+            continue;
+        }
+
+        // Speedup is relative to the single-thread run, or to the smallest count if 1 was not run
+        size_t base = std::min_element(thread_counts.begin(), thread_counts.end()) - thread_counts.begin();
+
+        std::cout << "\n" << circuit << " (" << reps << " runs per thread count)\n";
+        std::cout << std::left << std::setw(10) << "phase" << std::right << std::setw(8) << "threads"
+                  << std::setw(14) << "median us" << std::setw(14) << "p95 us" << std::setw(10) << "speedup" << '\n';
+        for (int p = 0; p < NUM_PHASES; ++p)
+        {
+            for (size_t t = 0; t < thread_counts.size(); ++t)
+            {
+                double speedup = median[t][p] > 0 ? median[base][p] / median[t][p] : 0.0;
+                std::cout << std::left << std::setw(10) << PHASES[p] << std::right << std::setw(8) << thread_counts[t]
+                          << std::fixed << std::setprecision(1) << std::setw(14) << median[t][p]
+                          << std::setw(14) << p95[t][p] << std::setprecision(2) << std::setw(10) << speedup << '\n';
+                csv << circuit << ',' << PHASES[p] << ',' << thread_counts[t] << ',' << reps << ','
+                    << std::setprecision(1) << median[t][p] << ',' << p95[t][p] << ','
+                    << std::setprecision(3) << speedup << '\n';
+            }
+        }
+        std::cout.flush();
+    }
+
+    std::cout << "\nResults written to " << csv_file << std::endl;
+    return 0;
+}
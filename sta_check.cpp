@@ -0,0 +1,311 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <set>
+#include <omp.h>
+#include "DAG.hpp"
+#include "Log.hpp"
+
+// Consistency checks that have no home in a timing run. Each check prints one PASS or FAIL
+// line; the exit status is the number of failures.
+
+static void usage(const char *prog)
+{
+    std::cerr << "Usage: " << prog << " [<filename>...]" << std::endl
+              << "Checks every netlist (default: circuits/json/*.json) and prints one line per check" << std::endl;
+}
+
+static int failures = 0;
+
+static void report(bool ok, const std::string &name, const std::string &detail = "")
+{
+    failures += !ok;
+    std::cout << (ok ? "PASS " : "FAIL ") << name << (detail.empty() ? "" : ": ") << detail << '\n';
+}
+
+// Full analysis of a netlist with the default task-graph pass, as sta.o runs it
+static void full_pass(DAG &dag, const ASIC &asic, const CellStore &cells)
+{
+    dag.buildFromASIC(asic);
+    dag.removeCycles();
+    dag.reverseList();
+    dag.createTaskGraph(asic);
+    dag.initializeRequiredTime(asic);
+    dag.topological_TaskGraph(dag, cells, asic);
+}
+
+static bool is_node(const DAG &dag, int bit)
+{
+    return dag.indexOf(bit) >= 0;
+}
+
+// The combinational cells with one output, the only ones the edits below touch
+static std::vector<int> editable_cells(const ASIC &asic, const DAG &dag)
+{
+    std::vector<int> editable;
+    for (int i = 0; i < static_cast<int>(asic.cells.size()); ++i)
+    {
+        const Cell &cell = asic.cells[i];
+        if (!is_sequential(cell.type) && cell.outputs.size() == 1 && cell.id == cell.outputs[0] &&
+            !cell.inputs.empty() && is_node(dag, cell.id))
+        {
+            editable.push_back(i);
+        }
+    }
+    return editable;
+}
+
+// Interning starts with an empty string, then fills a block past its end with an oversized
+// string; every view must keep its text and equal strings must share one copy
+static void check_string_table()
+{
+    StringTable table;
+    std::string_view empty = table.intern("");
+    std::string_view name = table.intern("net");
+    std::string big(100 << 10, 'x');
+    std::string_view large = table.intern(big);
+    std::string_view after = table.intern("after");
+
+    bool ok = empty.empty() && name == "net" && large == big && after == "after" &&
+              table.intern("").data() == empty.data() && table.intern("net").data() == name.data() &&
+              table.size() == 4;
+    report(ok, "string table", "interned \"\" first, then an oversized string");
+}
+
+// Runs the task-graph pass with more workers than OpenMP threads, as OMP_THREAD_LIMIT or
+// OMP_DYNAMIC can cause, and compares every node's slack with a single-thread run. Regions
+// of workers that never start must still be initialized.
+static void check_short_team(const std::string &file, const ASIC &asic)
+{
+    const std::string name = "short team " + std::filesystem::path(file).filename().string();
+    const int max_threads = omp_get_max_threads();
+    const int max_levels = omp_get_max_active_levels();
+    CellStore cells = create_cell_store(asic.cells);
+
+    DAG reference;
+    reference.setThreads(1);
+    full_pass(reference, asic, cells);
+
+    // No parallel region may be active, so every region runs on one thread for 8 workers
+    omp_set_max_active_levels(0);
+    DAG dag;
+    dag.setThreads(8);
+    full_pass(dag, asic, cells);
+    omp_set_max_active_levels(max_levels);
+    omp_set_num_threads(max_threads);
+
+    for (int bit : reference.nodeIds)
+    {
+        float expected = reference.slackOf(bit);
+        float actual = dag.slackOf(bit);
+        if (!(std::fabs(actual - expected) <= 1e-3f * std::max(1.0f, std::fabs(expected))))
+        {
+            report(false, name, "node " + std::to_string(bit) + " has slack " + std::to_string(actual) +
+                                    " on 1 thread for 8 workers, " + std::to_string(expected) + " on 1 worker");
+            return;
+        }
+    }
+    report(true, name, std::to_string(reference.numNodes()) + " nodes match with 8 workers on 1 thread");
+}
+
+// Memoized NLDM lookups over a sweep of slews and loads, inside and past the tables of
+// circuits/library.txt, must never come out below the exact interpolation
+static void check_nldm_cache()
+{
+    NldmLibrary library;
+    std::string error;
+    if (!load_nldm_library("circuits/library.txt", library, error))
+    {
+        report(false, "nldm cache", error);
+        return;
+    }
+
+    NldmCache cache;
+    int lookups = 0;
+    for (size_t t = 0; t < NUM_CELL_TYPES; ++t)
+    {
+        const NldmCell *cell = library.find(static_cast<CellType>(t));
+        if (!cell)
+        {
+            continue;
+        }
+        double max_slew = cell->delay.index_1.back();
+        double max_load = cell->delay.index_2.back();
+        for (int i = 0; i <= 40; ++i)
+        {
+            for (int j = 0; j <= 40; ++j)
+            {
+                double slew = max_slew * 1.5 * i / 40;
+                double load = max_load * 1.5 * j / 40;
+                auto [delay, out_slew] = cache.lookup(static_cast<CellType>(t), *cell, slew, load);
+                double exact_delay = cell->delay.lookup(slew, load);
+                double exact_slew = cell->slew.lookup(slew, load);
+                ++lookups;
+                if (delay < exact_delay - 1e-9 || out_slew < exact_slew - 1e-9)
+                {
+                    report(false, "nldm cache", "cell " + std::string(cell_spec(static_cast<CellType>(t)).name) +
+                                                    " at slew " + std::to_string(slew) + ", load " + std::to_string(load) +
+                                                    " gives delay " + std::to_string(delay) + " below " + std::to_string(exact_delay));
+                    return;
+                }
+            }
+        }
+    }
+    report(lookups > 0, "nldm cache", std::to_string(lookups) + " lookups never below the exact tables");
+}
+
+// Applies a cell-type change, an edge addition and an edge removal to a timed netlist with the
+// eco* API, then compares the slack of every endpoint after updateTiming with a full pass over
+// the same netlist edited in the ASIC
+static void check_eco(const std::string &file, const ASIC &parsed)
+{
+    const std::string name = "eco " + std::filesystem::path(file).filename().string();
+
+    ASIC asic = parsed;
+    CellStore cells = create_cell_store(asic.cells);
+    DAG dag;
+    full_pass(dag, asic, cells);
+
+    std::vector<int> editable = editable_cells(asic, dag);
+    if (editable.empty())
+    {
+        report(true, name, "skipped, no combinational cell to edit");
+        return;
+    }
+
+    // Cell-type change on the first editable cell
+    Cell &retyped = asic.cells[editable.front()];
+    CellType type = retyped.type == CellType::XOR ? CellType::AND : CellType::XOR;
+    retyped.type = type;
+    retyped.delay = get_delay(type);
+    std::tie(retyped.resistance, retyped.capacitance) = get_rc(type);
+    dag.ecoSetCellType(cells, retyped.id, type);
+    std::string edits = "retyped " + std::to_string(retyped.id);
+
+    // A new edge from a primary input into the last editable cell. Primary inputs have no
+    // fanin, so the edge cannot close a loop that removeCycles would cut differently.
+    Cell &extended = asic.cells[editable.back()];
+    int added = -1;
+    for (int bit : asic.inputs)
+    {
+        if (is_node(dag, bit) && bit != extended.id &&
+            std::find(extended.inputs.begin(), extended.inputs.end(), bit) == extended.inputs.end())
+        {
+            extended.inputs.push_back(bit);
+            added = bit;
+            dag.ecoAddEdge(bit, extended.id);
+            edits += ", added " + std::to_string(bit) + " -> " + std::to_string(extended.id);
+            break;
+        }
+    }
+
+    // Removal of an input edge whose source also feeds another cell, so both graphs keep the node
+    std::multiset<int> uses;
+    for (const Cell &cell : asic.cells)
+    {
+        if (!cell.outputs.empty())
+        {
+            uses.insert(cell.inputs.begin(), cell.inputs.end());
+        }
+    }
+    bool removed = false;
+    for (size_t i = 0; i < editable.size() && !removed; ++i)
+    {
+        Cell &cell = asic.cells[editable[i]];
+        for (int bit : cell.inputs)
+        {
+            size_t own = std::count(cell.inputs.begin(), cell.inputs.end(), bit);
+            bool just_added = &cell == &extended && bit == added;
+            if (cell.inputs.size() > own && uses.count(bit) > own && !just_added)
+            {
+                cell.inputs.erase(std::remove(cell.inputs.begin(), cell.inputs.end(), bit), cell.inputs.end());
+                dag.ecoRemoveEdge(bit, cell.id);
+                edits += ", removed " + std::to_string(bit) + " -> " + std::to_string(cell.id);
+                removed = true;
+                break;
+            }
+        }
+    }
+
+    dag.updateTiming(asic, cells);
+
+    CellStore fresh_cells = create_cell_store(asic.cells);
+    DAG fresh;
+    full_pass(fresh, asic, fresh_cells);
+
+    std::vector<int> endpoints = dag.endpoints();
+    std::vector<int> fresh_endpoints = fresh.endpoints();
+    std::sort(endpoints.begin(), endpoints.end());
+    std::sort(fresh_endpoints.begin(), fresh_endpoints.end());
+    if (endpoints != fresh_endpoints)
+    {
+        report(false, name, edits + "; endpoints differ from a full pass");
+        return;
+    }
+
+    for (int bit : endpoints)
+    {
+        float incremental = dag.slackOf(bit);
+        float full = fresh.slackOf(bit);
+        if (!(std::fabs(incremental - full) <= 1e-3f * std::max(1.0f, std::fabs(full))))
+        {
+            report(false, name, edits + "; endpoint " + std::to_string(bit) + " has slack " +
+                                    std::to_string(incremental) + ", full pass " + std::to_string(full));
+            return;
+        }
+    }
+    report(true, name, edits + "; " + std::to_string(endpoints.size()) + " endpoints match a full pass");
+}
+
+int main(int argc, char **argv)
+{
+    std::ios::sync_with_stdio(false);
+
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (argv[i][0] == '-')
+        {
+            usage(argv[0]);
+            return 1;
+        }
+        files.push_back(argv[i]);
+    }
+
+    if (files.empty())
+    {
+        std::error_code ec;
+        for (const auto &entry : std::filesystem::directory_iterator("circuits/json", ec))
+        {
+            if (entry.path().extension() == ".json")
+            {
+                files.push_back(entry.path().string());
+            }
+        }
+        std::sort(files.begin(), files.end());
+    }
+
+    // Only errors are printed; the checks report their own results
+    log_level = LOG_LEVEL_ERROR;
+
+    check_string_table();
+    check_nldm_cache();
+
+    for (const std::string &file : files)
+    {
+        ASIC asic = parse_json(file);
+        if (asic.cells.empty())
+        {
+            std::cerr << "Skipping " << file << ": no cells parsed" << std::endl;
+            continue;
+        }
+        assign_rc_to_cells(asic);
+        check_eco(file, asic);
+        check_short_team(file, asic);
+    }
+
+    std::cout << (failures ? "\n" + std::to_string(failures) + " check(s) failed" : std::string("\nAll checks passed")) << std::endl;
+    return failures;
+}
@@ -1,78 +1,224 @@
 #include <iostream>
 #include <fstream>
 #include <chrono>
+#include <cstring>
 #include "DAG.hpp"
-#include "verbose.h"
+#include "NetlistCache.hpp"
+#include "PathEngine.hpp"
+#include "Log.hpp"
 
 using namespace std::chrono;
 
+static void usage(const char *prog)
+{
+    std::cerr << "Usage: " << prog << " [-v|--verbose] [--log-level error|warn|info|debug|trace]"
+              << " [--dump-asic] [--dump-dag] [--dump-tasks] [--corners <file>] [--library <file>] [--paths <k>] [--levels] [--cluster <size>] [--staged] [--threads <n>] [--pin] [--compile] <filename>" << std::endl;
+}
+
 int main(int argc, char **argv)
 {
-    std::cout << "Static Timing Analysis" << std::endl;
+    // All output goes through the buffered C++ streams; results are flushed once at exit
+    std::ios::sync_with_stdio(false);
+    std::cout << "Static Timing Analysis\n";
 
     string filename = "circuits/json/bigcircuit.json";
+    bool compile = false;
+    string corners_file;
+    string library_file;
+    int num_paths = 0;
+    bool use_levels = false;
+    int cluster_size = 0;
+    bool staged = false;
+    int threads = 0;
+    bool pin = false;
+    bool dump_asic = false;
+    bool dump_dag = false;
+    bool dump_tasks = false;
 
-    if (argc > 1 && argc < 4)
+    for (int i = 1; i < argc; ++i)
     {
-        for (int i = 1; i < argc; ++i)
+        if (strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--verbose") == 0)
         {
-            if (strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--verbose") == 0)
-            {
-                verbose = true;
-            }
-            else
+            log_level = LOG_LEVEL_TRACE;
+        }
+        else if (strcmp(argv[i], "--log-level") == 0 && i + 1 < argc)
+        {
+            log_level = parse_log_level(argv[++i]);
+            if (log_level < 0)
             {
-                filename = argv[i];
+                usage(argv[0]);
+                return 1;
             }
         }
-    }
-    else if (argc > 3)
-    {
-        std::cerr << "Usage: " << argv[0] << " [-v|--verbose] <filename>" << std::endl;
-        return 1;
+        else if (strcmp(argv[i], "--dump-asic") == 0)
+        {
+            dump_asic = true;
+        }
+        else if (strcmp(argv[i], "--dump-dag") == 0)
+        {
+            dump_dag = true;
+        }
+        else if (strcmp(argv[i], "--dump-tasks") == 0)
+        {
+            dump_tasks = true;
+        }
+        else if (strcmp(argv[i], "--corners") == 0 && i + 1 < argc)
+        {
+            corners_file = argv[++i];
+        }
+        else if (strcmp(argv[i], "--library") == 0 && i + 1 < argc)
+        {
+            library_file = argv[++i];
+        }
+        else if (strcmp(argv[i], "--paths") == 0 && i + 1 < argc)
+        {
+            num_paths = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--levels") == 0)
+        {
+            use_levels = true;
+        }
+        else if (strcmp(argv[i], "--cluster") == 0 && i + 1 < argc)
+        {
+            cluster_size = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--staged") == 0)
+        {
+            staged = true;
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            threads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--pin") == 0)
+        {
+            pin = true;
+        }
+        else if (strcmp(argv[i], "--compile") == 0)
+        {
+            compile = true;
+        }
+        else if (argv[i][0] == '-')
+        {
+            usage(argv[0]);
+            return 1;
+        }
+        else
+        {
+            filename = argv[i];
+        }
     }
 
     auto start = high_resolution_clock::now();
 
-    ASIC asic = parse_json(filename);
-    assign_rc_to_cells(asic);
+    // A compiled netlist next to the source replaces parsing and graph construction
+    ASIC asic;
+    DAG dag;
+    dag.setThreads(threads, pin);
+    SourceStamp stamp = stamp_source_file(filename);
+    string cache_path = cache_path_for(filename);
+    bool cached = !compile && load_netlist_cache(cache_path, stamp, asic, dag);
+
+    if (!cached)
+    {
+        asic = parse_json(filename);
+        assign_rc_to_cells(asic);
+    }
 
     auto end = high_resolution_clock::now();
     auto duration = duration_cast<microseconds>(end - start).count();
-    cout << "\n[Time] Parsing JSON: " << duration << " us" << endl;
+    cout << "\n[Time] " << (cached ? "Loading netlist cache: " : "Parsing JSON: ") << duration << " us" << endl;
 
-    display_asic(asic);
+    if (dump_asic)
+    {
+        display_asic(asic);
+    }
 
     start = high_resolution_clock::now();
-    map<int, Cell> cell_map = create_cell_map(asic.cells);
+    CellStore cells = create_cell_store(asic.cells);
     end = high_resolution_clock::now();
     duration = duration_cast<microseconds>(end - start).count();
-    cout << "\n[Time] Creating Cell Map: " << duration << " us" << endl;
-
-    DAG dag;
+    cout << "\n[Time] Creating Cell Store: " << duration << " us" << endl;
 
     start = high_resolution_clock::now();
-    dag.buildFromASIC(asic);
+    if (!cached)
+    {
+        dag.buildFromASIC(asic);
+    }
     end = high_resolution_clock::now();
     duration = duration_cast<microseconds>(end - start).count();
     cout << "\n[Time] Building DAG: " << duration << " us" << endl;
 
-    std::cout << "\nDAG Representation of the ASIC:" << std::endl;
-    dag.displayGraph(asic);
-    dag.removeCycles();
+    if (dump_dag)
+    {
+        std::cout << "\nDAG Representation of the ASIC:\n";
+        dag.displayGraph(asic);
+    }
+    if (!cached)
+    {
+        dag.removeCycles();
+    }
+
+    if (compile)
+    {
+        if (!stamp.valid || !write_netlist_cache(cache_path, stamp, asic, dag))
+        {
+            std::cerr << "Failed to compile " << filename << std::endl;
+            return 1;
+        }
+        std::cout << "\nCompiled netlist written to " << cache_path << std::endl;
+        return 0;
+    }
+
     dag.reverseList();
+    if (!library_file.empty())
+    {
+        NldmLibrary library;
+        string error;
+        if (!load_nldm_library(library_file, library, error))
+        {
+            std::cerr << "Error reading library: " << error << std::endl;
+            return 1;
+        }
+
+        start = high_resolution_clock::now();
+        dag.annotateDelays(cells, library);
+        end = high_resolution_clock::now();
+        duration = duration_cast<microseconds>(end - start).count();
+        cout << "\n[Time] NLDM annotation: " << duration << " us" << endl;
+    }
+    dag.stagedForward = staged;
     dag.createTaskGraph(asic);
 
-    dag.initializeRequiredTime(asic, cell_map);
-    dag.printTaskGraph();
+    dag.initializeRequiredTime(asic);
+    if (dump_tasks)
+    {
+        dag.printTaskGraph();
+    }
+    if (cluster_size > 0 && !use_levels)
+    {
+        start = high_resolution_clock::now();
+        dag.buildClusters(cluster_size);
+        end = high_resolution_clock::now();
+        duration = duration_cast<microseconds>(end - start).count();
+        cout << "\n[Time] Clustering tasks: " << duration << " us" << endl;
+    }
     start = high_resolution_clock::now();
 
-    std::vector<int> sorted = dag.topological_TaskGraph(dag, cell_map, asic);
+    std::vector<int> sorted = use_levels         ? dag.levelSweep(cells)
+                              : cluster_size > 0 ? dag.clusteredTaskGraph(cells, asic)
+                                                 : dag.topological_TaskGraph(dag, cells, asic);
 
     end = high_resolution_clock::now();
     auto duration_top = duration_cast<microseconds>(end - start).count();
     cout << "\n[Time] Topological Sort (Forward Pass): " << duration_top << " us" << endl;
 
+    // Reported after the timed span, so the pass itself never logs
+    if (!use_levels && (pin || log_level >= LOG_LEVEL_DEBUG))
+    {
+        dag.reportNumaStats(cluster_size > 0 ? "Cluster tasks" : "Task graph");
+    }
+
     start = high_resolution_clock::now();
 
     std::unordered_map<int, float> slack = dag.computeSlack(asic, sorted);
@@ -81,11 +227,11 @@ int main(int argc, char **argv)
     duration = duration_cast<microseconds>(end - start).count();
     cout << "\n[Time] Analyze Timing (Backward Pass): " << duration << " us" << endl;
 
-    std::cout << "\nRESULTS:" << std::endl;
+    std::cout << "\nRESULTS:\n";
 
     for (const auto &[net, s] : slack)
     {
-        std::string name = asic.net_dict.count(net) ? asic.net_dict.at(net) : "Unknown";
+        std::string_view name = asic.net_dict.count(net) ? asic.net_dict.at(net) : "Unknown";
         std::cout << "Node " << name << " (ID: " << net << ") | Slack: " << s;
 
         if (s < 0)
@@ -97,7 +243,80 @@ int main(int argc, char **argv)
             std::cout << " | Timing OK!";
         }
 
-        std::cout << std::endl;
+        std::cout << '\n';
+    }
+
+    std::unordered_map<int, float> hold_slack = dag.computeHoldSlack(asic);
+
+    std::cout << "\nHOLD RESULTS:\n";
+    for (const auto &[net, s] : hold_slack)
+    {
+        std::string_view name = asic.net_dict.count(net) ? asic.net_dict.at(net) : "Unknown";
+        std::cout << "Endpoint " << name << " (ID: " << net << ") | Hold slack: " << s
+                  << (s < 0 ? " | Hold Violation!" : " | Hold OK!") << '\n';
+    }
+
+    if (num_paths > 0)
+    {
+        start = high_resolution_clock::now();
+        PathEngine engine(dag, cells);
+        std::vector<int> endpoints = dag.endpoints();
+        std::vector<std::vector<TimingPath>> paths = engine.worstPaths(endpoints, num_paths);
+        end = high_resolution_clock::now();
+        auto duration_paths = duration_cast<microseconds>(end - start).count();
+
+        std::cout << "\nWORST PATHS:\n";
+        for (size_t i = 0; i < endpoints.size(); ++i)
+        {
+            std::string_view name = asic.net_dict.count(endpoints[i]) ? asic.net_dict.at(endpoints[i]) : "Unknown";
+            std::cout << "Endpoint " << name << " (ID: " << endpoints[i] << ")\n";
+            for (size_t p = 0; p < paths[i].size(); ++p)
+            {
+                const TimingPath &path = paths[i][p];
+                std::cout << "  #" << p + 1 << " | Arrival: " << path.arrival << " | Path slack: " << path.slack << " |";
+                for (size_t n = 0; n < path.nodes.size(); ++n)
+                {
+                    int bit = path.nodes[n];
+                    std::cout << (n ? " -> " : " ") << (asic.net_dict.count(bit) ? asic.net_dict.at(bit) : std::to_string(bit));
+                }
+                std::cout << '\n';
+            }
+        }
+
+        cout << "\n[Time] Path extraction (" << num_paths << " per endpoint): " << duration_paths << " us" << endl;
+    }
+
+    if (!corners_file.empty())
+    {
+        std::vector<Corner> corners;
+        string error;
+        if (!load_corners(corners_file, corners, error))
+        {
+            std::cerr << "Error reading corners: " << error << std::endl;
+            return 1;
+        }
+
+        start = high_resolution_clock::now();
+        dag.analyzeCorners(cells, corners);
+        end = high_resolution_clock::now();
+        auto duration_corners = duration_cast<microseconds>(end - start).count();
+
+        std::cout << "\nCORNER RESULTS:\n";
+        for (const auto &[net, s] : slack)
+        {
+            std::string_view name = asic.net_dict.count(net) ? asic.net_dict.at(net) : "Unknown";
+            std::cout << "Node " << name << " (ID: " << net << ")";
+            bool violation = false;
+            for (int c = 0; c < static_cast<int>(corners.size()); ++c)
+            {
+                float corner_slack = dag.cornerSlack(net, c);
+                violation |= corner_slack < 0;
+                std::cout << " | " << corners[c].name << ": " << corner_slack;
+            }
+            std::cout << (violation ? " | Timing Violation!" : " | Timing OK!") << '\n';
+        }
+
+        cout << "\n[Time] Multi-corner analysis (" << corners.size() << " corners): " << duration_corners << " us" << endl;
     }
 
     cout << "\n[Time] Topological Sort (Forward Pass): " << duration_top << " us" << endl;
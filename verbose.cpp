@@ -1,3 +0,0 @@
-#include "verbose.h"
-
-bool verbose = false;
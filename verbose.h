@@ -1,6 +0,0 @@
-#ifndef CONFIG_H
-#define CONFIG_H
-
-extern bool verbose;
-
-#endif